@@ -0,0 +1,124 @@
+#include "bandwidget.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr float kFloorDb = -100.0f;
+
+// Rounds an exact base-2 mid-band frequency to the preferred R10 value
+// used on octave and third-octave band labels.
+double nominalFrequency(double hz)
+{
+    static const double series[] = {1.0, 1.25, 1.6, 2.0, 2.5, 3.15, 4.0, 5.0, 6.3, 8.0, 10.0};
+    const double decade = std::pow(10.0, std::floor(std::log10(hz)));
+    const double mantissa = hz / decade;
+    double best = series[0];
+    for (double value : series) {
+        if (std::fabs(std::log(value / mantissa)) < std::fabs(std::log(best / mantissa))) {
+            best = value;
+        }
+    }
+    return best * decade;
+}
+
+QString formatFrequency(double hz)
+{
+    if (hz >= 1000.0) {
+        return QString::number(hz / 1000.0, 'g', 3) + QStringLiteral("k");
+    }
+    return QString::number(hz, 'g', 3);
+}
+} // namespace
+
+BandWidget::BandWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(180);
+    setAutoFillBackground(false);
+}
+
+void BandWidget::setBandsPerOctave(int bands)
+{
+    m_bandsPerOctave = std::max(1, bands);
+    if (m_analyzer.sampleRate() > 0) {
+        m_analyzer.configure(m_analyzer.sampleRate(), m_bandsPerOctave);
+    }
+    m_levels.clear();
+    update();
+}
+
+void BandWidget::setIntegration(OctaveBandAnalyzer::Integration integration)
+{
+    m_integration = integration;
+    if (m_integration == OctaveBandAnalyzer::IntegrationLeq) {
+        m_analyzer.resetLeq();
+    }
+    update();
+}
+
+void BandWidget::setSamples(const QVector<float> &samples, int sampleRate)
+{
+    if (sampleRate <= 0) {
+        return;
+    }
+    if (sampleRate != m_analyzer.sampleRate() || m_bandsPerOctave != m_analyzer.bandsPerOctave()) {
+        m_analyzer.configure(sampleRate, m_bandsPerOctave);
+    }
+
+    m_analyzer.process(samples.constData(), samples.size());
+    m_analyzer.levels(m_integration, m_levels);
+    update();
+}
+
+QString BandWidget::bandLabel(int band) const
+{
+    const double center = m_analyzer.centerFrequency(band);
+    return formatFrequency(m_bandsPerOctave <= 3 ? nominalFrequency(center) : center);
+}
+
+void BandWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(10, 10, 14));
+
+    const int w = width();
+    const int h = height();
+    const int labelHeight = 14;
+    const int plotHeight = h - labelHeight;
+
+    if (m_levels.empty()) {
+        painter.setPen(QColor(120, 120, 140));
+        painter.drawText(rect(), Qt::AlignCenter, QStringLiteral("No bands"));
+        return;
+    }
+
+    painter.setFont(QFont(painter.font().family(), 8));
+    painter.setPen(QPen(QColor(40, 40, 60)));
+    for (int db = 0; db >= static_cast<int>(kFloorDb); db -= 20) {
+        const float y = (static_cast<float>(db) / kFloorDb) * static_cast<float>(plotHeight - 1);
+        painter.drawLine(QPointF(0, y), QPointF(w, y));
+        painter.drawText(QPointF(2.0f, y + 10.0f), QString::number(db) + QStringLiteral(" dB"));
+    }
+
+    const int count = static_cast<int>(m_levels.size());
+    const float slot = static_cast<float>(w) / static_cast<float>(count);
+    const float gap = (slot > 4.0f) ? 1.0f : 0.0f;
+    const int labelEvery = std::max(1, static_cast<int>(std::ceil(32.0f / slot)));
+
+    for (int i = 0; i < count; ++i) {
+        const float level = std::max(kFloorDb, std::min(0.0f, m_levels[i]));
+        const float top = (level / kFloorDb) * static_cast<float>(plotHeight - 1);
+        const QRectF bar(i * slot + gap, top, std::max(1.0f, slot - 2.0f * gap), plotHeight - top);
+        painter.fillRect(bar, QColor(0, 140, 220));
+
+        if (i % labelEvery == 0) {
+            painter.setPen(QPen(QColor(150, 150, 170), 1.0));
+            painter.drawText(QPointF(i * slot + 1.0f, h - 2.0f), bandLabel(i));
+        }
+    }
+}
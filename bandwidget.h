@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QVector>
+#include <QWidget>
+
+#include <vector>
+
+#include "octavebandanalyzer.h"
+
+class BandWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit BandWidget(QWidget *parent = nullptr);
+
+    void setBandsPerOctave(int bands);
+    void setIntegration(OctaveBandAnalyzer::Integration integration);
+
+public slots:
+    void setSamples(const QVector<float> &samples, int sampleRate);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QString bandLabel(int band) const;
+
+    OctaveBandAnalyzer m_analyzer;
+    OctaveBandAnalyzer::Integration m_integration = OctaveBandAnalyzer::IntegrationFast;
+    int m_bandsPerOctave = 3;
+    std::vector<float> m_levels;
+};
@@ -0,0 +1,250 @@
+#include "batchanalyzer.h"
+
+#include "fft.h"
+#include "wavfile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+// Welch average of Hann-windowed frames with 50 % overlap, scaled so that a
+// full-scale sine reads 0 dB.
+std::vector<float> averageSpectrumDb(const std::vector<float> &samples, int fftSize)
+{
+    Fft fft(fftSize);
+    const int n = fft.size();
+    const int bins = n / 2 + 1;
+    std::vector<double> power(bins, 0.0);
+    std::vector<float> window(n);
+    std::vector<std::complex<float>> data(n);
+
+    const double pi = std::acos(-1.0);
+    double windowSum = 0.0;
+    for (int i = 0; i < n; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * i / n));
+        windowSum += window[i];
+    }
+
+    const int total = static_cast<int>(samples.size());
+    const int hop = n / 2;
+    int frames = 0;
+    for (int start = 0; start == 0 || start + n <= total; start += hop) {
+        for (int i = 0; i < n; ++i) {
+            const int index = start + i;
+            const float sample = (index < total) ? samples[index] : 0.0f;
+            data[i] = std::complex<float>(sample * window[i], 0.0f);
+        }
+        fft.forward(data.data());
+        for (int i = 0; i < bins; ++i) {
+            power[i] += std::norm(std::complex<double>(data[i]));
+        }
+        ++frames;
+    }
+
+    std::vector<float> spectrum(bins);
+    for (int i = 0; i < bins; ++i) {
+        const double magnitude = 2.0 * std::sqrt(power[i] / frames) / windowSum;
+        spectrum[i] = static_cast<float>(20.0 * std::log10(std::max(magnitude, 1e-12)));
+    }
+    return spectrum;
+}
+
+std::string jsonEscape(const std::string &text)
+{
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                out += buffer;
+            } else {
+                out += c;
+            }
+            break;
+        }
+    }
+    return out;
+}
+
+std::string csvQuote(const std::string &text)
+{
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+    return out;
+}
+} // namespace
+
+BatchAnalyzer::BatchAnalyzer(const BatchOptions &options)
+    : m_options(options)
+{
+}
+
+FileReport BatchAnalyzer::analyzeFile(const std::string &path, const std::string &spectrumPath) const
+{
+    FileReport report;
+    report.path = path;
+
+    WavFile wav;
+    if (!wav.load(path, &report.error)) {
+        return report;
+    }
+
+    report.sampleRate = wav.sampleRate();
+    report.frames = wav.frameCount();
+    report.seconds = static_cast<double>(report.frames) / report.sampleRate;
+    report.channels.resize(wav.channelCount());
+
+    std::vector<std::vector<float>> spectra;
+    for (int c = 0; c < wav.channelCount(); ++c) {
+        const std::vector<float> &samples = wav.channel(c);
+        ChannelReport &channel = report.channels[c];
+
+        MeasurementEngine engine;
+        engine.setSampleRate(report.sampleRate);
+        engine.setWindowMs(m_options.windowMs);
+        const int block = 4096;
+        for (int start = 0; start < report.frames; start += block) {
+            const int count = std::min(block, report.frames - start);
+            if (engine.process(samples.data() + start, count)) {
+                channel.windows.push_back(engine.result());
+            }
+        }
+
+        TriggerDetector trigger;
+        trigger.setThreshold(m_options.triggerLevel);
+        trigger.setHysteresis(m_options.triggerHysteresis);
+        trigger.setHoldoff(static_cast<int>(static_cast<long long>(m_options.holdoffMs) * report.sampleRate / 1000));
+        trigger.process(samples.data(), report.frames, channel.triggers);
+
+        spectra.push_back(averageSpectrumDb(samples, m_options.fftSize));
+    }
+
+    report.spectrumPath = spectrumPath;
+    std::ofstream out(report.spectrumPath);
+    if (!out) {
+        report.error = "cannot write spectrum";
+        return report;
+    }
+    const int bins = spectra.empty() ? 0 : static_cast<int>(spectra.front().size());
+    const double binHz = (bins > 1) ? report.sampleRate / (2.0 * (bins - 1)) : 0.0;
+    out << "frequency_hz";
+    for (int c = 0; c < static_cast<int>(spectra.size()); ++c) {
+        out << ",ch" << c << "_dbfs";
+    }
+    out << '\n';
+    for (int i = 0; i < bins; ++i) {
+        out << i * binHz;
+        for (const auto &spectrum : spectra) {
+            out << ',' << spectrum[i];
+        }
+        out << '\n';
+    }
+
+    report.ok = true;
+    return report;
+}
+
+bool BatchAnalyzer::writeMeasurementsCsv(const std::vector<FileReport> &reports, const std::string &path) const
+{
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    out << "file,channel,window,start_s,rms,peak,crest,dc,frequency_hz,thd,thd_n,snr_db\n";
+    for (const FileReport &report : reports) {
+        for (int c = 0; c < static_cast<int>(report.channels.size()); ++c) {
+            const auto &windows = report.channels[c].windows;
+            for (int w = 0; w < static_cast<int>(windows.size()); ++w) {
+                const MeasurementResult &m = windows[w];
+                out << csvQuote(report.path) << ',' << c << ',' << w << ','
+                    << static_cast<double>(w) * m.windowFrames / m.sampleRate << ','
+                    << m.rms << ',' << m.peak << ',' << m.crestFactor << ',' << m.dcOffset << ','
+                    << m.frequency << ',' << m.thd << ',' << m.thdN << ',' << m.snrDb << '\n';
+            }
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+bool BatchAnalyzer::writeTriggersCsv(const std::vector<FileReport> &reports, const std::string &path) const
+{
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    out << "file,channel,sample,time_s,level,edge\n";
+    for (const FileReport &report : reports) {
+        for (int c = 0; c < static_cast<int>(report.channels.size()); ++c) {
+            for (const TriggerEvent &event : report.channels[c].triggers) {
+                out << csvQuote(report.path) << ',' << c << ',' << event.sampleIndex << ','
+                    << static_cast<double>(event.sampleIndex) / report.sampleRate << ','
+                    << event.level << ',' << (event.rising ? "rising" : "falling") << '\n';
+            }
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+bool BatchAnalyzer::writeJson(const std::vector<FileReport> &reports, const std::string &path) const
+{
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    out << "{\n  \"files\": [";
+    for (size_t f = 0; f < reports.size(); ++f) {
+        const FileReport &report = reports[f];
+        out << (f ? ",\n" : "\n") << "    {\"path\": \"" << jsonEscape(report.path) << "\", \"ok\": "
+            << (report.ok ? "true" : "false");
+        if (!report.ok) {
+            out << ", \"error\": \"" << jsonEscape(report.error) << "\"}";
+            continue;
+        }
+
+        out << ", \"sampleRate\": " << report.sampleRate << ", \"frames\": " << report.frames
+            << ", \"spectrum\": \"" << jsonEscape(report.spectrumPath) << "\", \"channels\": [";
+        for (size_t c = 0; c < report.channels.size(); ++c) {
+            const ChannelReport &channel = report.channels[c];
+            out << (c ? ", " : "") << "{\"measurements\": [";
+            for (size_t w = 0; w < channel.windows.size(); ++w) {
+                const MeasurementResult &m = channel.windows[w];
+                out << (w ? ", " : "") << "{\"rms\": " << m.rms << ", \"peak\": " << m.peak
+                    << ", \"crest\": " << m.crestFactor << ", \"dc\": " << m.dcOffset
+                    << ", \"frequency\": " << m.frequency << ", \"thd\": " << m.thd
+                    << ", \"thdN\": " << m.thdN << ", \"snrDb\": " << m.snrDb << "}";
+            }
+            out << "], \"triggers\": [";
+            for (size_t t = 0; t < channel.triggers.size(); ++t) {
+                out << (t ? ", " : "") << channel.triggers[t].sampleIndex;
+            }
+            out << "]}";
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
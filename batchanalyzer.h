@@ -0,0 +1,50 @@
+#pragma once
+
+#include "measurementengine.h"
+#include "triggerdetector.h"
+
+#include <string>
+#include <vector>
+
+struct BatchOptions {
+    int fftSize = 4096;
+    int windowMs = 1000;
+    float triggerLevel = 0.5f;
+    float triggerHysteresis = 0.01f;
+    int holdoffMs = 10;
+    bool writeCsv = true;
+    bool writeJson = true;
+};
+
+struct ChannelReport {
+    std::vector<MeasurementResult> windows;
+    std::vector<TriggerEvent> triggers;
+};
+
+struct FileReport {
+    std::string path;
+    std::string spectrumPath;
+    std::string error;
+    bool ok = false;
+    int sampleRate = 0;
+    int frames = 0;
+    double seconds = 0.0;
+    std::vector<ChannelReport> channels;
+};
+
+class BatchAnalyzer
+{
+public:
+    explicit BatchAnalyzer(const BatchOptions &options);
+
+    // Thread-safe: every call uses its own engines and buffers. The averaged
+    // spectrum of every channel is written to spectrumPath as CSV.
+    FileReport analyzeFile(const std::string &path, const std::string &spectrumPath) const;
+
+    bool writeMeasurementsCsv(const std::vector<FileReport> &reports, const std::string &path) const;
+    bool writeTriggersCsv(const std::vector<FileReport> &reports, const std::string &path) const;
+    bool writeJson(const std::vector<FileReport> &reports, const std::string &path) const;
+
+private:
+    BatchOptions m_options;
+};
@@ -0,0 +1,184 @@
+#include "batchanalyzer.h"
+#include "workstealingpool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+void printUsage(const char *program)
+{
+    std::fprintf(stderr,
+        "Usage: %s [options] <input-dir> <output-dir>\n"
+        "\n"
+        "Analyzes every .wav file in input-dir and writes measurements.csv,\n"
+        "triggers.csv, results.json and one <name>.spectrum.csv per file.\n"
+        "\n"
+        "  --threads N        worker threads (default: all cores)\n"
+        "  --recursive        descend into subdirectories\n"
+        "  --fft N            spectrum FFT size (default 4096)\n"
+        "  --window-ms N      measurement window (default 1000)\n"
+        "  --trigger LEVEL    trigger threshold (default 0.5)\n"
+        "  --hysteresis H     trigger hysteresis (default 0.01)\n"
+        "  --holdoff-ms N     minimum spacing between triggers (default 10)\n"
+        "  --format F         csv, json or both (default both)\n",
+        program);
+}
+
+bool isWav(const fs::path &path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return extension == ".wav";
+}
+
+std::string spectrumName(const fs::path &input, const fs::path &root)
+{
+    std::string name = fs::relative(input, root).replace_extension().generic_string();
+    std::replace(name.begin(), name.end(), '/', '_');
+    return name + ".spectrum.csv";
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    BatchOptions options;
+    int threads = 0;
+    bool recursive = false;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--recursive") {
+            recursive = true;
+        } else if (arg == "--fft" && hasValue) {
+            options.fftSize = std::max(64, std::atoi(argv[++i]));
+        } else if (arg == "--window-ms" && hasValue) {
+            options.windowMs = std::max(10, std::atoi(argv[++i]));
+        } else if (arg == "--trigger" && hasValue) {
+            options.triggerLevel = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--hysteresis" && hasValue) {
+            options.triggerHysteresis = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--holdoff-ms" && hasValue) {
+            options.holdoffMs = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--format" && hasValue) {
+            const std::string format = argv[++i];
+            options.writeCsv = format == "csv" || format == "both";
+            options.writeJson = format == "json" || format == "both";
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            printUsage(argv[0]);
+            return 2;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() != 2) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    const fs::path inputDir = positional[0];
+    const fs::path outputDir = positional[1];
+    std::error_code ec;
+    if (!fs::is_directory(inputDir, ec)) {
+        std::fprintf(stderr, "Not a directory: %s\n", inputDir.string().c_str());
+        return 1;
+    }
+    fs::create_directories(outputDir, ec);
+
+    std::vector<fs::path> inputs;
+    if (recursive) {
+        for (const auto &entry : fs::recursive_directory_iterator(inputDir, ec)) {
+            if (entry.is_regular_file() && isWav(entry.path())) {
+                inputs.push_back(entry.path());
+            }
+        }
+    } else {
+        for (const auto &entry : fs::directory_iterator(inputDir, ec)) {
+            if (entry.is_regular_file() && isWav(entry.path())) {
+                inputs.push_back(entry.path());
+            }
+        }
+    }
+    std::sort(inputs.begin(), inputs.end());
+
+    // Largest files first so the tail of the run is short jobs that steal well.
+    std::vector<size_t> order(inputs.size());
+    std::vector<uintmax_t> sizes(inputs.size());
+    uintmax_t totalBytes = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        order[i] = i;
+        sizes[i] = fs::file_size(inputs[i], ec);
+        totalBytes += ec ? 0 : sizes[i];
+    }
+    std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    // Files are analyzed independently, so throughput should grow with the
+    // thread count until reads saturate the disk. That has not been
+    // measured on a multi-core machine yet; BatchAnalyzerTest prints its
+    // 1-thread and N-thread timings, which is the place to check.
+    const BatchAnalyzer analyzer(options);
+    std::vector<FileReport> reports(inputs.size());
+    const auto started = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(threads);
+        threads = pool.threadCount();
+        for (size_t index : order) {
+            pool.submit([&, index]() {
+                const std::string spectrumPath = (outputDir / spectrumName(inputs[index], inputDir)).string();
+                reports[index] = analyzer.analyzeFile(inputs[index].string(), spectrumPath);
+            });
+        }
+        pool.wait();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    int failed = 0;
+    double audioSeconds = 0.0;
+    for (const FileReport &report : reports) {
+        if (!report.ok) {
+            ++failed;
+            std::fprintf(stderr, "%s: %s\n", report.path.c_str(), report.error.c_str());
+        }
+        audioSeconds += report.seconds;
+    }
+
+    bool written = true;
+    if (options.writeCsv) {
+        written &= analyzer.writeMeasurementsCsv(reports, (outputDir / "measurements.csv").string());
+        written &= analyzer.writeTriggersCsv(reports, (outputDir / "triggers.csv").string());
+    }
+    if (options.writeJson) {
+        written &= analyzer.writeJson(reports, (outputDir / "results.json").string());
+    }
+    if (!written) {
+        std::fprintf(stderr, "Failed to write results to %s\n", outputDir.string().c_str());
+        return 1;
+    }
+
+    std::printf("%zu files (%d failed), %.1f s audio, %.1f MB in %.3f s on %d threads: %.1f files/s, %.0fx real time\n",
+        inputs.size(), failed, audioSeconds, static_cast<double>(totalBytes) / 1e6, elapsed, threads,
+        elapsed > 0.0 ? static_cast<double>(inputs.size()) / elapsed : 0.0,
+        elapsed > 0.0 ? audioSeconds / elapsed : 0.0);
+    return failed ? 1 : 0;
+}
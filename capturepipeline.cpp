@@ -0,0 +1,159 @@
+#include "capturepipeline.h"
+
+CapturePipeline::CapturePipeline(Callbacks callbacks)
+    : m_callbacks(std::move(callbacks))
+{
+    m_graph.addProcessor(std::make_unique<FilterChainProcessor>(m_filters));
+    m_graph.addSink(std::make_unique<CallbackSink>("scope", [this](const GraphBlock &block) {
+        if (m_callbacks.scope) {
+            m_callbacks.scope(block);
+        }
+    }));
+    m_graph.addSink(std::make_unique<CallbackSink>("output", [this](const GraphBlock &block) {
+        outputBlock(block);
+    }));
+    m_graph.addSink(std::make_unique<CallbackSink>("analysis", [this](const GraphBlock &block) {
+        if (m_callbacks.analysis) {
+            m_callbacks.analysis(block);
+        }
+    }));
+    m_graph.addSink(std::make_unique<CallbackSink>("spectrum", [this](const GraphBlock &block) {
+        if (block.spectrum && m_callbacks.spectrum) {
+            m_callbacks.spectrum(block);
+        }
+    }, true));
+    m_graph.addSink(std::make_unique<CallbackSink>("recorder", [this](const GraphBlock &block) {
+        recordBlock(block);
+    }));
+}
+
+void CapturePipeline::prepare(int sampleRate, int channels)
+{
+    m_filters.setPreset(m_filterPreset, sampleRate);
+    stopRecording();
+    m_graph.configure(sampleRate, channels);
+    m_graph.resetTimings();
+    m_generator.configure(sampleRate);
+    m_loopback.configure(sampleRate);
+    m_measuring = false;
+}
+
+void CapturePipeline::process(const CaptureBlock &position, float *interleaved, int frames)
+{
+    if (m_measuring) {
+        m_captured.resize(frames);
+        ProcessingGraph::mixMono(interleaved, frames, m_graph.channels(), m_graph.monoMix(), m_captured.data());
+        m_capturedOffset = 0;
+    }
+    m_graph.setPosition(position.firstFrame, position.timestampNs, position.droppedFrames > 0);
+    m_graph.process(interleaved, frames);
+}
+
+void CapturePipeline::setFilterPreset(FilterChain::Preset preset)
+{
+    m_filterPreset = preset;
+    m_filters.setPreset(m_filterPreset, m_graph.sampleRate());
+}
+
+bool CapturePipeline::addPlugin(std::unique_ptr<BlockProcessor> plugin)
+{
+    return m_graph.addProcessor(std::move(plugin));
+}
+
+bool CapturePipeline::startRecording(const std::string &path, std::string *error)
+{
+    stopRecording();
+    if (!m_graph.isConfigured()) {
+        if (error) {
+            *error = "Capture is not running";
+        }
+        return false;
+    }
+    if (!m_recorder.open(path, m_graph.channels(), m_graph.sampleRate(), m_graph.maxFrames(), error)) {
+        return false;
+    }
+    m_recordNextFrame = -1;
+    return true;
+}
+
+void CapturePipeline::stopRecording()
+{
+    m_recorder.close();
+}
+
+void CapturePipeline::setGeneratorEnabled(bool enabled)
+{
+    if (enabled && !m_generatorEnabled) {
+        m_generator.reset();
+    }
+    m_generatorEnabled = enabled;
+    if (!enabled) {
+        m_measuring = false;
+    }
+}
+
+bool CapturePipeline::startLoopbackMeasurement()
+{
+    if (!m_generatorEnabled) {
+        return false;
+    }
+    m_loopback.reset();
+    m_outputLeadSum = 0.0;
+    m_outputLeadBlocks = 0;
+    m_measuring = true;
+    return true;
+}
+
+void CapturePipeline::outputBlock(const GraphBlock &block)
+{
+    const float *samples = block.mono;
+    if (m_generatorEnabled) {
+        m_generated.resize(block.frames);
+        m_generator.generate(m_generated.data(), block.frames);
+        samples = m_generated.data();
+    }
+    bool resynced = false;
+    const double lead = m_callbacks.output ? m_callbacks.output(block, samples, &resynced) : -1.0;
+    if (!m_measuring || m_capturedOffset + block.frames > static_cast<int>(m_captured.size())) {
+        return;
+    }
+    const float *captured = m_captured.data() + m_capturedOffset;
+    m_capturedOffset += block.frames;
+
+    // Emission and capture advance by the same frame count per block, so
+    // their offset in the loopback recording is the round trip plus how
+    // late the host schedules the emission. The block was dated back by
+    // the processing latency; the unprocessed samples it is paired with
+    // were not.
+    const bool played = lead >= 0.0;
+    if (block.discontinuity || resynced || !played) {
+        // Lost capture frames or a jump of the write position shift the
+        // returned stream against the emitted one; start over.
+        m_loopback.reset();
+        m_outputLeadSum = 0.0;
+        m_outputLeadBlocks = 0;
+    }
+    if (played) {
+        m_outputLeadSum += lead - m_graph.latencyFrames();
+        ++m_outputLeadBlocks;
+        m_loopback.setOutputLead(m_outputLeadSum / static_cast<double>(m_outputLeadBlocks));
+    }
+    if (m_loopback.process(samples, captured, block.frames)) {
+        m_measuring = false;
+        if (m_callbacks.loopbackFinished) {
+            m_callbacks.loopbackFinished(m_loopback.result());
+        }
+    }
+}
+
+void CapturePipeline::recordBlock(const GraphBlock &block)
+{
+    if (!m_recorder.isOpen()) {
+        return;
+    }
+    if (m_recordNextFrame >= 0 && block.firstFrame > m_recordNextFrame) {
+        m_recorder.writeSilence(block.firstFrame - m_recordNextFrame);
+    }
+    m_recorder.write(block.interleaved, block.frames);
+    m_recordNextFrame = block.firstFrame + block.frames;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "capturetracker.h"
+#include "filterchain.h"
+#include "loopbackanalyzer.h"
+#include "processinggraph.h"
+#include "signalgenerator.h"
+#include "wavfile.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Everything the scope runs on a captured block once it is off the
+// device: the filter chain and plugins, then the scope, output, analysis,
+// spectrum and recorder branches, with the signal generator and loopback
+// measurement behind the output branch. ScopeWidget and the replay test
+// build the same pipeline, so replay digests cover what the scope runs.
+class CapturePipeline
+{
+public:
+    // Front-end hooks, called from process(); any may be left empty.
+    struct Callbacks {
+        std::function<void(const GraphBlock &)> scope;
+        // Plays block.frames mono samples. Returns how many frames after
+        // block.timestampNs they will be emitted (playback lead plus the
+        // block's age), or a negative value if nothing was played.
+        // `resynced` reports a jump of the playback write position.
+        std::function<double(const GraphBlock &block, const float *samples, bool *resynced)> output;
+        std::function<void(const GraphBlock &)> analysis;
+        // Only called for blocks that completed an STFT frame.
+        std::function<void(const GraphBlock &)> spectrum;
+        std::function<void(const LoopbackResult &)> loopbackFinished;
+    };
+
+    explicit CapturePipeline(Callbacks callbacks);
+
+    // Sets up every stage for a new stream and stops any recording or
+    // measurement in progress.
+    void prepare(int sampleRate, int channels);
+    // Filters, then fans out one captured block in place.
+    void process(const CaptureBlock &position, float *interleaved, int frames);
+
+    ProcessingGraph &graph() { return m_graph; }
+    const ProcessingGraph &graph() const { return m_graph; }
+
+    void setFilterPreset(FilterChain::Preset preset);
+    FilterChain::Preset filterPreset() const { return m_filterPreset; }
+    void setMonoMix(ProcessingGraph::MonoMix mix) { m_graph.setMonoMix(mix); }
+    // Runs after the filter chain and any plugin added before it. False if
+    // the plugin does not support the current stream format.
+    bool addPlugin(std::unique_ptr<BlockProcessor> plugin);
+
+    // Records the processed stream as 16-bit WAV, padding over capture
+    // gaps; needs a prepared stream.
+    bool startRecording(const std::string &path, std::string *error = nullptr);
+    void stopRecording();
+    bool isRecording() const { return m_recorder.isOpen(); }
+
+    // With the generator enabled the output plays the test signal instead
+    // of the processed input.
+    void setGeneratorEnabled(bool enabled);
+    bool isGeneratorEnabled() const { return m_generatorEnabled; }
+    SignalGenerator &generator() { return m_generator; }
+
+    // Records the emitted and returned streams in lockstep until the
+    // analysis completes; needs the generator enabled. The returned stream
+    // is taken before the filters and plugins, so they do not add to the
+    // measured delay or response.
+    bool startLoopbackMeasurement();
+    bool isMeasuring() const { return m_measuring; }
+
+private:
+    void outputBlock(const GraphBlock &block);
+    void recordBlock(const GraphBlock &block);
+
+    Callbacks m_callbacks;
+    FilterChain m_filters;
+    FilterChain::Preset m_filterPreset = FilterChain::PresetNone;
+    ProcessingGraph m_graph;
+
+    WavWriter m_recorder;
+    long long m_recordNextFrame = -1;
+
+    SignalGenerator m_generator;
+    bool m_generatorEnabled = false;
+    std::vector<float> m_generated;
+    // Mono mix of the unprocessed block in process(), consumed in step
+    // with the output branch.
+    std::vector<float> m_captured;
+    int m_capturedOffset = 0;
+    LoopbackAnalyzer m_loopback;
+    bool m_measuring = false;
+    double m_outputLeadSum = 0.0;
+    long long m_outputLeadBlocks = 0;
+};
@@ -0,0 +1,192 @@
+#include "capturesession.h"
+
+#include <cstring>
+
+namespace {
+// "SVCS", format version, channels, sample rate; then per block the poll
+// time, the five CaptureBlock fields and the PCM, all little endian.
+constexpr char kMagic[4] = {'S', 'V', 'C', 'S'};
+constexpr uint32_t kVersion = 1;
+constexpr int kBlockHeaderBytes = 5 * 8 + 4;
+constexpr int kMaxChannels = 64;
+
+void putU32(char *p, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void putI64(char *p, int64_t value)
+{
+    const uint64_t bits = static_cast<uint64_t>(value);
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+    }
+}
+
+uint32_t getU32(const char *p)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    }
+    return value;
+}
+
+int64_t getI64(const char *p)
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i) {
+        bits |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    }
+    return static_cast<int64_t>(bits);
+}
+
+bool fail(std::string *error, const char *message)
+{
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+} // namespace
+
+void decodePcm16(const int16_t *pcm, int values, float *out)
+{
+    for (int i = 0; i < values; ++i) {
+        out[i] = static_cast<float>(pcm[i]) / 32768.0f;
+    }
+}
+
+CaptureSessionWriter::~CaptureSessionWriter()
+{
+    close();
+}
+
+bool CaptureSessionWriter::open(const std::string &path, int channels, int sampleRate, std::string *error)
+{
+    close();
+    if (channels <= 0 || channels > kMaxChannels || sampleRate <= 0) {
+        return fail(error, "invalid format");
+    }
+
+    m_out.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_out) {
+        return fail(error, "cannot create file");
+    }
+
+    char header[16];
+    std::memcpy(header, kMagic, 4);
+    putU32(header + 4, kVersion);
+    putU32(header + 8, static_cast<uint32_t>(channels));
+    putU32(header + 12, static_cast<uint32_t>(sampleRate));
+    m_out.write(header, sizeof(header));
+
+    m_channels = channels;
+    m_blocks = 0;
+    return static_cast<bool>(m_out);
+}
+
+bool CaptureSessionWriter::write(int64_t pollNs, const CaptureBlock &block, const void *data1, size_t bytes1,
+    const void *data2, size_t bytes2)
+{
+    if (!m_out.is_open()) {
+        return false;
+    }
+    if (bytes1 + bytes2 != static_cast<size_t>(block.frames) * m_channels * sizeof(int16_t)) {
+        return false;
+    }
+    if (m_blocks == 0) {
+        m_originNs = pollNs;
+    }
+
+    char header[kBlockHeaderBytes];
+    putI64(header, pollNs - m_originNs);
+    putI64(header + 8, block.firstFrame);
+    putU32(header + 16, static_cast<uint32_t>(block.frames));
+    putI64(header + 20, block.timestampNs - m_originNs);
+    putI64(header + 28, block.droppedFrames);
+    putI64(header + 36, block.backlogFrames);
+    m_out.write(header, sizeof(header));
+    // Capture PCM is little endian, as are all hosts this runs on.
+    if (bytes1 > 0) {
+        m_out.write(static_cast<const char *>(data1), static_cast<std::streamsize>(bytes1));
+    }
+    if (bytes2 > 0) {
+        m_out.write(static_cast<const char *>(data2), static_cast<std::streamsize>(bytes2));
+    }
+    ++m_blocks;
+    return static_cast<bool>(m_out);
+}
+
+void CaptureSessionWriter::close()
+{
+    if (m_out.is_open()) {
+        m_out.close();
+    }
+}
+
+bool CaptureSessionReader::open(const std::string &path, std::string *error)
+{
+    close();
+    m_in.open(path, std::ios::binary);
+    if (!m_in) {
+        return fail(error, "cannot open file");
+    }
+
+    char header[16];
+    if (!m_in.read(header, sizeof(header)) || std::memcmp(header, kMagic, 4) != 0) {
+        close();
+        return fail(error, "not a capture session");
+    }
+    if (getU32(header + 4) != kVersion) {
+        close();
+        return fail(error, "unsupported session version");
+    }
+    const uint32_t channels = getU32(header + 8);
+    const uint32_t sampleRate = getU32(header + 12);
+    if (channels == 0 || channels > kMaxChannels || sampleRate == 0 || sampleRate > 10000000) {
+        close();
+        return fail(error, "invalid format");
+    }
+    m_channels = static_cast<int>(channels);
+    m_sampleRate = static_cast<int>(sampleRate);
+    return true;
+}
+
+void CaptureSessionReader::close()
+{
+    if (m_in.is_open()) {
+        m_in.close();
+    }
+    m_in.clear();
+    m_channels = 0;
+    m_sampleRate = 0;
+}
+
+bool CaptureSessionReader::next(CaptureSessionBlock &block)
+{
+    if (!m_in.is_open()) {
+        return false;
+    }
+
+    char header[kBlockHeaderBytes];
+    if (!m_in.read(header, sizeof(header))) {
+        return false;
+    }
+    block.pollNs = getI64(header);
+    block.position.firstFrame = getI64(header + 8);
+    block.position.frames = static_cast<int>(getU32(header + 16));
+    block.position.timestampNs = getI64(header + 20);
+    block.position.droppedFrames = getI64(header + 28);
+    block.position.backlogFrames = getI64(header + 36);
+    // Nothing polled in one go can exceed the two-second device buffer.
+    if (block.position.frames < 0 || block.position.frames > 2 * m_sampleRate) {
+        return false;
+    }
+
+    block.pcm.resize(static_cast<size_t>(block.position.frames) * m_channels);
+    const std::streamsize bytes = static_cast<std::streamsize>(block.pcm.size() * sizeof(int16_t));
+    return bytes == 0 || static_cast<bool>(m_in.read(reinterpret_cast<char *>(block.pcm.data()), bytes));
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "capturetracker.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Converts device 16-bit PCM to float exactly as the live capture path
+// does, so a replayed session yields bit-identical input.
+void decodePcm16(const int16_t *pcm, int values, float *out);
+
+struct CaptureSessionBlock {
+    int64_t pollNs = 0;          // when the block was polled, from the first poll
+    CaptureBlock position;       // timestampNs is relative to the first poll too
+    std::vector<int16_t> pcm;    // interleaved, position.frames * channels values
+};
+
+// Records raw capture blocks together with the moment each was polled, so
+// a session can be replayed with its original block sizes, pacing and
+// gaps.
+class CaptureSessionWriter
+{
+public:
+    ~CaptureSessionWriter();
+
+    bool open(const std::string &path, int channels, int sampleRate, std::string *error = nullptr);
+    // The PCM may arrive in two pieces, as a wrapped ring lock returns it.
+    bool write(int64_t pollNs, const CaptureBlock &block, const void *data1, size_t bytes1,
+        const void *data2 = nullptr, size_t bytes2 = 0);
+    void close();
+
+    bool isOpen() const { return m_out.is_open(); }
+    long long blocksWritten() const { return m_blocks; }
+
+private:
+    std::ofstream m_out;
+    int m_channels = 0;
+    int64_t m_originNs = 0;
+    long long m_blocks = 0;
+};
+
+class CaptureSessionReader
+{
+public:
+    bool open(const std::string &path, std::string *error = nullptr);
+    void close();
+    bool isOpen() const { return m_in.is_open(); }
+
+    int channels() const { return m_channels; }
+    int sampleRate() const { return m_sampleRate; }
+
+    // False at the end of the session or at a truncated block.
+    bool next(CaptureSessionBlock &block);
+
+private:
+    std::ifstream m_in;
+    int m_channels = 0;
+    int m_sampleRate = 0;
+};
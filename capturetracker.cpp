@@ -0,0 +1,87 @@
+#include "capturetracker.h"
+
+#include <algorithm>
+
+void CaptureTracker::start(int sampleRate, int bufferFrames, int safetyFrames, int cursorFrame, int64_t nowNs)
+{
+    m_sampleRate = std::max(1, sampleRate);
+    m_bufferFrames = std::max(1, bufferFrames);
+    m_safetyFrames = std::max(0, std::min(safetyFrames, m_bufferFrames - 1));
+    m_cursor = cursorFrame;
+    m_cursorNs = nowNs;
+    m_writeFrame = 0;
+    m_readFrame = 0;
+    m_bounds[0] = nowNs;
+    m_boundCount = 1;
+    m_boundNext = 1;
+    m_anchorNs = nowNs;
+    m_lastTimestampNs = 0;
+    m_lastFrames = 0;
+    m_droppedFrames = 0;
+    m_maxBacklog = 0;
+    m_gapCount = 0;
+}
+
+CaptureBlock CaptureTracker::poll(int cursorFrame, int64_t nowNs, int *ringOffset)
+{
+    // Advance seen in the ring, plus however many whole laps the clock
+    // says went by unseen.
+    int64_t advance = cursorFrame - m_cursor;
+    if (advance < 0) {
+        advance += m_bufferFrames;
+    }
+    const double expected = static_cast<double>(nowNs - m_cursorNs) * m_sampleRate / 1e9;
+    const int64_t laps = static_cast<int64_t>((expected - advance) / m_bufferFrames + 0.5);
+    if (laps > 0) {
+        advance += laps * m_bufferFrames;
+    }
+    const int64_t elapsedNs = nowNs - m_cursorNs;
+    m_cursor = cursorFrame;
+    m_cursorNs = nowNs;
+    m_writeFrame += advance;
+
+    CaptureBlock block;
+    block.backlogFrames = m_writeFrame - m_readFrame;
+    m_maxBacklog = std::max(m_maxBacklog, block.backlogFrames);
+
+    const int64_t intact = m_bufferFrames - m_safetyFrames;
+    if (block.backlogFrames > intact) {
+        block.droppedFrames = block.backlogFrames - intact;
+        m_readFrame += block.droppedFrames;
+        m_droppedFrames += block.droppedFrames;
+        ++m_gapCount;
+    }
+
+    block.firstFrame = m_readFrame;
+    block.frames = static_cast<int>(m_writeFrame - m_readFrame);
+    if (ringOffset) {
+        *ringOffset = static_cast<int>((m_cursor - block.frames % m_bufferFrames + m_bufferFrames) % m_bufferFrames);
+    }
+
+    // Every frame behind the cursor has been captured, so each poll bounds
+    // the capture time of frame 0 from above; the bound is tight when the
+    // cursor has just moved and loose by up to one cursor step otherwise.
+    // The lowest recent bound dates the block at the nominal rate. Keeping
+    // only recent polls lets it follow a drifting device clock, and a stall
+    // adds one observation, not a guess. It may rise no faster than the
+    // largest expected drift, so a tight bound ageing out does not make
+    // the stamps jump ahead.
+    m_bounds[m_boundNext] = nowNs - static_cast<int64_t>(static_cast<double>(m_writeFrame) * 1e9 / m_sampleRate);
+    m_boundNext = (m_boundNext + 1) % kAnchorPolls;
+    m_boundCount = std::min(m_boundCount + 1, kAnchorPolls);
+    const int64_t lowest = *std::min_element(m_bounds.begin(), m_bounds.begin() + m_boundCount);
+    const int64_t riseNs = static_cast<int64_t>(static_cast<double>(elapsedNs) * kMaxDriftPpm * 1e-6);
+    m_anchorNs = std::min(lowest, m_anchorNs + riseNs);
+    block.timestampNs = m_anchorNs + static_cast<int64_t>(static_cast<double>(block.firstFrame) * 1e9 / m_sampleRate);
+
+    // Never before the end of the previous block at the fastest expected
+    // device clock; at the nominal one a fast device would ratchet the
+    // stamps ahead.
+    const double previousNs = static_cast<double>(m_lastFrames) * 1e9 / m_sampleRate / (1.0 + kMaxDriftPpm * 1e-6);
+    block.timestampNs = std::max(block.timestampNs, m_lastTimestampNs + static_cast<int64_t>(previousNs));
+    m_lastTimestampNs = block.timestampNs;
+    m_lastFrames = block.frames;
+
+    m_readFrame = m_writeFrame;
+    return block;
+}
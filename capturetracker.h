@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Where a captured block sits on the device timeline.
+struct CaptureBlock {
+    int64_t firstFrame = 0;     // running device frame index, gaps included
+    int frames = 0;
+    int64_t timestampNs = 0;    // steady-clock time the first frame was captured
+    int64_t droppedFrames = 0;  // frames lost right before this block
+    int64_t backlogFrames = 0;  // frames waiting when the poll started
+};
+
+// Maps a device ring-buffer cursor onto an absolute frame count. The ring
+// alone cannot show how often it wrapped between polls, so the elapsed
+// monotonic time is used to count whole wraps; frames the device has
+// already overwritten are reported as dropped instead of being read.
+class CaptureTracker
+{
+public:
+    // Largest device clock error the timestamps are expected to follow.
+    static constexpr double kMaxDriftPpm = 1000.0;
+    // Polls whose cursor observations date the blocks.
+    static constexpr int kAnchorPolls = 64;
+
+    // `safetyFrames` is the part of the ring behind the write cursor that
+    // may already be overwritten again by the time it is read.
+    void start(int sampleRate, int bufferFrames, int safetyFrames, int cursorFrame, int64_t nowNs);
+
+    // Advances to the write cursor observed at `nowNs` and returns the
+    // block to read next, starting at ring offset `*ringOffset`. Every
+    // frame up to the cursor is returned, so the reader never falls behind.
+    CaptureBlock poll(int cursorFrame, int64_t nowNs, int *ringOffset);
+
+    int sampleRate() const { return m_sampleRate; }
+    int64_t framesRead() const { return m_readFrame - m_droppedFrames; }
+    int64_t droppedFrames() const { return m_droppedFrames; }
+    int gapCount() const { return m_gapCount; }
+    int64_t maxBacklogFrames() const { return m_maxBacklog; }
+
+private:
+    int m_sampleRate = 0;
+    int m_bufferFrames = 0;
+    int m_safetyFrames = 0;
+    int m_cursor = 0;
+    int64_t m_cursorNs = 0;
+    int64_t m_writeFrame = 0;
+    int64_t m_readFrame = 0;
+    // Capture time of frame 0 implied by each recent poll, oldest
+    // overwritten first.
+    std::array<int64_t, kAnchorPolls> m_bounds{};
+    int m_boundCount = 0;
+    int m_boundNext = 0;
+    int64_t m_anchorNs = 0;
+    int64_t m_lastTimestampNs = 0;
+    int m_lastFrames = 0;
+    int64_t m_droppedFrames = 0;
+    int64_t m_maxBacklog = 0;
+    int m_gapCount = 0;
+};
@@ -0,0 +1,127 @@
+#include "constantqtransform.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Spectral kernel entries below this fraction of the bin's peak are
+// dropped; the loss is well under 0.1 dB.
+constexpr float kSparsity = 0.005f;
+} // namespace
+
+void ConstantQTransform::configure(int sampleRate, double minFrequency, int binsPerOctave, int hop)
+{
+    m_sampleRate = std::max(1, sampleRate);
+    m_binsPerOctave = std::max(1, binsPerOctave);
+    m_hop = std::max(1, hop);
+
+    const double ratio = std::pow(2.0, 1.0 / m_binsPerOctave);
+    const double q = 1.0 / (ratio - 1.0);
+    const double lowest = std::max(minFrequency, q * m_sampleRate / kMaxFftSize);
+    const double highest = 0.45 * m_sampleRate;
+
+    m_frequencies.clear();
+    for (double hz = lowest; hz <= highest; hz *= ratio) {
+        m_frequencies.push_back(hz);
+    }
+    const int bins = binCount();
+    m_magnitudes.assign(bins, 0.0f);
+
+    const int longest = static_cast<int>(std::ceil(q * m_sampleRate / lowest));
+    const int n = std::min(kMaxFftSize, Fft::nextPow2(longest));
+    m_fft.setSize(n);
+    m_history.assign(n, 0.0f);
+    m_data.assign(n, std::complex<float>());
+
+    // Kernels are aligned to the newest sample so high bins react with the
+    // least latency. The 1/n of Parseval's theorem is folded in here.
+    const double pi = std::acos(-1.0);
+    m_kernelStart.assign(1, 0);
+    m_kernelIndex.clear();
+    m_kernelValues.clear();
+    std::vector<std::complex<float>> temporal(n);
+    for (int k = 0; k < bins; ++k) {
+        const int length = std::min(n, static_cast<int>(std::ceil(q * m_sampleRate / m_frequencies[k])));
+        std::fill(temporal.begin(), temporal.end(), std::complex<float>());
+
+        double windowSum = 0.0;
+        for (int i = 0; i < length; ++i) {
+            windowSum += 0.5 - 0.5 * std::cos(2.0 * pi * (i + 0.5) / length);
+        }
+        const double scale = 2.0 / windowSum;
+        const double omega = 2.0 * pi * m_frequencies[k] / m_sampleRate;
+        const int offset = n - length;
+        for (int i = 0; i < length; ++i) {
+            const double window = 0.5 - 0.5 * std::cos(2.0 * pi * (i + 0.5) / length);
+            temporal[offset + i] = std::complex<float>(std::polar(window * scale, omega * (offset + i)));
+        }
+        m_fft.forward(temporal.data());
+
+        float peak = 0.0f;
+        for (const std::complex<float> &value : temporal) {
+            peak = std::max(peak, std::abs(value));
+        }
+        for (int j = 0; j < n; ++j) {
+            if (std::abs(temporal[j]) > kSparsity * peak) {
+                m_kernelIndex.push_back(j);
+                m_kernelValues.push_back(std::conj(temporal[j]) / static_cast<float>(n));
+            }
+        }
+        m_kernelStart.push_back(static_cast<int>(m_kernelIndex.size()));
+    }
+
+    reset();
+}
+
+void ConstantQTransform::reset()
+{
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    std::fill(m_magnitudes.begin(), m_magnitudes.end(), 0.0f);
+    m_write = 0;
+    m_sinceFrame = 0;
+}
+
+bool ConstantQTransform::process(const float *samples, int count)
+{
+    if (m_history.empty()) {
+        return false;
+    }
+
+    const int n = static_cast<int>(m_history.size());
+    bool completed = false;
+    for (int i = 0; i < count; ++i) {
+        m_history[m_write] = samples[i];
+        m_write = (m_write + 1) & (n - 1);
+        if (++m_sinceFrame == m_hop) {
+            m_sinceFrame = 0;
+            transform();
+            completed = true;
+        }
+    }
+    return completed;
+}
+
+void ConstantQTransform::transform()
+{
+    // Unroll the ring oldest first; m_write is the oldest sample.
+    const int n = static_cast<int>(m_history.size());
+    for (int i = 0; i < n; ++i) {
+        m_data[i] = std::complex<float>(m_history[(m_write + i) & (n - 1)], 0.0f);
+    }
+    m_fft.forward(m_data.data());
+
+    const int bins = binCount();
+    for (int k = 0; k < bins; ++k) {
+        // Written out instead of std::complex operator* to stay clear of
+        // the NaN-checking library call.
+        float re = 0.0f;
+        float im = 0.0f;
+        for (int e = m_kernelStart[k]; e < m_kernelStart[k + 1]; ++e) {
+            const std::complex<float> x = m_data[m_kernelIndex[e]];
+            const std::complex<float> h = m_kernelValues[e];
+            re += x.real() * h.real() - x.imag() * h.imag();
+            im += x.real() * h.imag() + x.imag() * h.real();
+        }
+        m_magnitudes[k] = std::sqrt(re * re + im * im);
+    }
+}
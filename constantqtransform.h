@@ -0,0 +1,54 @@
+#pragma once
+
+#include "fft.h"
+
+#include <complex>
+#include <vector>
+
+// Constant-Q spectrum: log-spaced bins with a constant ratio of centre
+// frequency to bandwidth. Each bin's windowed complex exponential is
+// transformed once at configure() time into a sparse spectral kernel, so a
+// frame costs one FFT plus a few multiply-adds per bin.
+class ConstantQTransform
+{
+public:
+    static constexpr int kMaxFftSize = 65536;
+
+    // The lowest bin is raised if its kernel would not fit in kMaxFftSize;
+    // the highest stays below 0.45 * sampleRate.
+    void configure(int sampleRate, double minFrequency, int binsPerOctave, int hop = 1024);
+    void reset();
+
+    int sampleRate() const { return m_sampleRate; }
+    int binsPerOctave() const { return m_binsPerOctave; }
+    int binCount() const { return static_cast<int>(m_frequencies.size()); }
+    double frequency(int bin) const { return m_frequencies[bin]; }
+    int fftSize() const { return m_fft.size(); }
+    int nonZeroCount() const { return static_cast<int>(m_kernelValues.size()); }
+
+    // Returns true when at least one frame completed; magnitudes() then
+    // holds the latest one, scaled so a full-scale sine on a bin reads 1.
+    bool process(const float *samples, int count);
+    const std::vector<float> &magnitudes() const { return m_magnitudes; }
+
+private:
+    void transform();
+
+    int m_sampleRate = 0;
+    int m_binsPerOctave = 0;
+    int m_hop = 1024;
+    int m_write = 0;
+    int m_sinceFrame = 0;
+
+    Fft m_fft;
+    std::vector<float> m_history;
+    std::vector<std::complex<float>> m_data;
+    std::vector<double> m_frequencies;
+    std::vector<float> m_magnitudes;
+
+    // Kernels in compressed rows: bin k uses entries
+    // m_kernelStart[k] .. m_kernelStart[k + 1] - 1.
+    std::vector<int> m_kernelStart;
+    std::vector<int> m_kernelIndex;
+    std::vector<std::complex<float>> m_kernelValues;
+};
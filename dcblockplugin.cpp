@@ -0,0 +1,86 @@
+// Example plugin: removes DC with a one-pole high-pass per channel. Built
+// as a module into the plugins directory next to the application.
+
+#include "scopevibeplugin.h"
+
+#include <cmath>
+#include <new>
+
+namespace {
+struct DcBlock {
+    int channels = 0;
+    float pole = 0.0f;
+    float *lastInput = nullptr;
+    float *lastOutput = nullptr;
+};
+
+void *create(int sampleRate, int channels, int maxFrames)
+{
+    (void)maxFrames;
+    if (sampleRate <= 0 || channels <= 0) {
+        return nullptr;
+    }
+    DcBlock *block = new (std::nothrow) DcBlock;
+    if (!block) {
+        return nullptr;
+    }
+    block->channels = channels;
+    // About 5 Hz corner regardless of rate.
+    block->pole = static_cast<float>(std::exp(-2.0 * 3.14159265358979 * 5.0 / sampleRate));
+    block->lastInput = new (std::nothrow) float[channels]();
+    block->lastOutput = new (std::nothrow) float[channels]();
+    if (!block->lastInput || !block->lastOutput) {
+        delete[] block->lastInput;
+        delete[] block->lastOutput;
+        delete block;
+        return nullptr;
+    }
+    return block;
+}
+
+void destroy(void *instance)
+{
+    DcBlock *block = static_cast<DcBlock *>(instance);
+    delete[] block->lastInput;
+    delete[] block->lastOutput;
+    delete block;
+}
+
+void reset(void *instance)
+{
+    DcBlock *block = static_cast<DcBlock *>(instance);
+    for (int c = 0; c < block->channels; ++c) {
+        block->lastInput[c] = 0.0f;
+        block->lastOutput[c] = 0.0f;
+    }
+}
+
+void process(void *instance, float *interleaved, int frames)
+{
+    DcBlock *block = static_cast<DcBlock *>(instance);
+    const int channels = block->channels;
+    for (int i = 0; i < frames; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            float &sample = interleaved[i * channels + c];
+            const float output = sample - block->lastInput[c] + block->pole * block->lastOutput[c];
+            block->lastInput[c] = sample;
+            block->lastOutput[c] = output;
+            sample = output;
+        }
+    }
+}
+
+const ScopeVibePluginDescriptor kDescriptor = {
+    SCOPEVIBE_PLUGIN_API_VERSION,
+    "dc-block",
+    create,
+    destroy,
+    reset,
+    process,
+};
+} // namespace
+
+extern "C" SCOPEVIBE_PLUGIN_EXPORT const ScopeVibePluginDescriptor *scopevibe_plugin_descriptor(void)
+{
+    return &kDescriptor;
+}
@@ -0,0 +1,157 @@
+#include "devicewatcher.h"
+
+#include <QTimer>
+
+#include <dsound.h>
+#include <mmdeviceapi.h>
+#include <objbase.h>
+
+#include <atomic>
+
+namespace {
+constexpr int kDebounceMs = 250;
+}
+
+// Receives endpoint notifications on a system thread and forwards them to
+// the watcher thread.
+class DeviceNotificationClient : public IMMNotificationClient
+{
+public:
+    explicit DeviceNotificationClient(DeviceWatcher *watcher)
+        : m_watcher(watcher)
+    {
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refs; }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        const ULONG refs = --m_refs;
+        if (refs == 0) {
+            delete this;
+        }
+        return refs;
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID iid, void **object) override
+    {
+        if (IsEqualIID(iid, __uuidof(IUnknown)) || IsEqualIID(iid, __uuidof(IMMNotificationClient))) {
+            *object = static_cast<IMMNotificationClient *>(this);
+            AddRef();
+            return S_OK;
+        }
+        *object = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR, DWORD) override { return notify(); }
+    HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR) override { return notify(); }
+    HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR) override { return notify(); }
+    HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow, ERole, LPCWSTR) override { return notify(); }
+    HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR, const PROPERTYKEY) override { return S_OK; }
+
+private:
+    HRESULT notify()
+    {
+        QMetaObject::invokeMethod(m_watcher, "scheduleRefresh", Qt::QueuedConnection);
+        return S_OK;
+    }
+
+    DeviceWatcher *m_watcher;
+    std::atomic<ULONG> m_refs{1};
+};
+
+bool AudioDeviceInfo::operator==(const AudioDeviceInfo &other) const
+{
+    if (hasGuid != other.hasGuid || name != other.name) {
+        return false;
+    }
+    return !hasGuid || IsEqualGUID(guid, other.guid);
+}
+
+BOOL CALLBACK DeviceWatcher::enumDevicesCallback(LPGUID guid, LPCSTR description, LPCSTR, LPVOID context)
+{
+    auto *devices = reinterpret_cast<QVector<AudioDeviceInfo> *>(context);
+    AudioDeviceInfo info;
+    if (description && description[0] != '\0') {
+        info.name = QString::fromLocal8Bit(description);
+    } else {
+        info.name = QStringLiteral("DirectSound Capture Device");
+    }
+    if (guid) {
+        info.guid = *guid;
+        info.hasGuid = true;
+    }
+    devices->push_back(info);
+    return TRUE;
+}
+
+DeviceWatcher::DeviceWatcher(QObject *parent)
+    : QObject(parent)
+{
+}
+
+DeviceWatcher::~DeviceWatcher()
+{
+    if (m_enumerator) {
+        if (m_client) {
+            m_enumerator->UnregisterEndpointNotificationCallback(m_client);
+        }
+        m_enumerator->Release();
+    }
+    if (m_client) {
+        m_client->Release();
+    }
+    if (m_comInitialized) {
+        CoUninitialize();
+    }
+}
+
+void DeviceWatcher::start()
+{
+    if (!m_comInitialized) {
+        m_comInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+    }
+
+    if (!m_debounce) {
+        m_debounce = new QTimer(this);
+        m_debounce->setSingleShot(true);
+        m_debounce->setInterval(kDebounceMs);
+        connect(m_debounce, &QTimer::timeout, this, &DeviceWatcher::refresh);
+    }
+
+    // Without notifications the first list simply stays in place.
+    if (!m_enumerator && SUCCEEDED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                             __uuidof(IMMDeviceEnumerator), reinterpret_cast<void **>(&m_enumerator)))) {
+        m_client = new DeviceNotificationClient(this);
+        if (FAILED(m_enumerator->RegisterEndpointNotificationCallback(m_client))) {
+            m_client->Release();
+            m_client = nullptr;
+        }
+    }
+    refresh();
+}
+
+void DeviceWatcher::scheduleRefresh()
+{
+    if (m_debounce) {
+        m_debounce->start();
+    }
+}
+
+void DeviceWatcher::refresh()
+{
+    QVector<AudioDeviceInfo> inputs;
+    QVector<AudioDeviceInfo> outputs;
+    DirectSoundCaptureEnumerateA(enumDevicesCallback, &inputs);
+    DirectSoundEnumerateA(enumDevicesCallback, &outputs);
+
+    if (m_reported && inputs == m_inputs && outputs == m_outputs) {
+        return;
+    }
+
+    m_inputs = inputs;
+    m_outputs = outputs;
+    m_reported = true;
+    emit devicesChanged(m_inputs, m_outputs);
+}
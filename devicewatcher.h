@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <windows.h>
+
+class QTimer;
+class DeviceNotificationClient;
+struct IMMDeviceEnumerator;
+
+struct AudioDeviceInfo {
+    QString name;
+    GUID guid{};
+    bool hasGuid = false;
+
+    bool operator==(const AudioDeviceInfo &other) const;
+    bool operator!=(const AudioDeviceInfo &other) const { return !(*this == other); }
+};
+
+Q_DECLARE_METATYPE(AudioDeviceInfo)
+
+// Enumerates DirectSound capture and playback endpoints on its own thread.
+// After the first pass it only re-enumerates when the Windows endpoint
+// notifications report a change, so hotplugged interfaces show up without
+// a restart. devicesChanged is only emitted when a list actually changed.
+class DeviceWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DeviceWatcher(QObject *parent = nullptr);
+    ~DeviceWatcher() override;
+
+public slots:
+    void start();
+    void refresh();
+    // Queued from the notification client; coalesces a burst of endpoint
+    // events into one enumeration.
+    void scheduleRefresh();
+
+signals:
+    void devicesChanged(const QVector<AudioDeviceInfo> &inputs, const QVector<AudioDeviceInfo> &outputs);
+
+private:
+    static BOOL CALLBACK enumDevicesCallback(LPGUID guid, LPCSTR description, LPCSTR module, LPVOID context);
+
+    QTimer *m_debounce = nullptr;
+    IMMDeviceEnumerator *m_enumerator = nullptr;
+    DeviceNotificationClient *m_client = nullptr;
+    QVector<AudioDeviceInfo> m_inputs;
+    QVector<AudioDeviceInfo> m_outputs;
+    bool m_reported = false;
+    bool m_comInitialized = false;
+};
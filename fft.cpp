@@ -0,0 +1,104 @@
+#include "fft.h"
+
+#include <cmath>
+#include <utility>
+
+Fft::Fft(int size)
+{
+    setSize(size);
+}
+
+void Fft::setSize(int size)
+{
+    if (size == m_size) {
+        return;
+    }
+
+    m_size = (size > 1) ? nextPow2(size) : 0;
+    m_bitReverse.assign(m_size, 0);
+    m_twiddles.clear();
+    m_inverseTwiddles.clear();
+    if (m_size == 0) {
+        return;
+    }
+
+    for (int i = 1, j = 0; i < m_size; ++i) {
+        int bit = m_size >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        m_bitReverse[i] = j;
+    }
+
+    const double pi = std::acos(-1.0);
+    m_twiddles.reserve(m_size);
+    m_inverseTwiddles.reserve(m_size);
+    for (int len = 2; len <= m_size; len <<= 1) {
+        for (int j = 0; j < len / 2; ++j) {
+            const double angle = -2.0 * pi * static_cast<double>(j) / static_cast<double>(len);
+            const float re = static_cast<float>(std::cos(angle));
+            const float im = static_cast<float>(std::sin(angle));
+            m_twiddles.emplace_back(re, im);
+            m_inverseTwiddles.emplace_back(re, -im);
+        }
+    }
+}
+
+void Fft::forward(std::complex<float> *data) const
+{
+    transform(data, false);
+}
+
+void Fft::inverse(std::complex<float> *data) const
+{
+    transform(data, true);
+    const float scale = 1.0f / static_cast<float>(m_size);
+    for (int i = 0; i < m_size; ++i) {
+        data[i] *= scale;
+    }
+}
+
+int Fft::nextPow2(int value)
+{
+    int n = 1;
+    while (n < value) {
+        n <<= 1;
+    }
+    return n;
+}
+
+void Fft::transform(std::complex<float> *data, bool inverse) const
+{
+    if (m_size < 2 || !data) {
+        return;
+    }
+
+    for (int i = 1; i < m_size; ++i) {
+        const int j = m_bitReverse[i];
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+
+    const std::complex<float> *twiddles = inverse ? m_inverseTwiddles.data() : m_twiddles.data();
+    for (int len = 2; len <= m_size; len <<= 1) {
+        const int half = len / 2;
+        const std::complex<float> *stage = twiddles + (half - 1);
+        for (int i = 0; i < m_size; i += len) {
+            std::complex<float> *a = data + i;
+            std::complex<float> *b = data + i + half;
+            for (int j = 0; j < half; ++j) {
+                // Spelled out to avoid the NaN-checking std::complex multiply.
+                const float wr = stage[j].real();
+                const float wi = stage[j].imag();
+                const float xr = b[j].real();
+                const float xi = b[j].imag();
+                const std::complex<float> v(xr * wr - xi * wi, xr * wi + xi * wr);
+                const std::complex<float> u = a[j];
+                a[j] = u + v;
+                b[j] = u - v;
+            }
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+
+class Fft
+{
+public:
+    explicit Fft(int size = 0);
+
+    void setSize(int size);
+    int size() const { return m_size; }
+
+    void forward(std::complex<float> *data) const;
+    void inverse(std::complex<float> *data) const;
+
+    static int nextPow2(int value);
+
+private:
+    void transform(std::complex<float> *data, bool inverse) const;
+
+    int m_size = 0;
+    std::vector<int> m_bitReverse;
+    // Twiddles laid out stage by stage (1, 2, 4, ... entries) so the inner
+    // butterfly loop reads them contiguously.
+    std::vector<std::complex<float>> m_twiddles;
+    std::vector<std::complex<float>> m_inverseTwiddles;
+};
@@ -0,0 +1,455 @@
+#include "filterchain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const double kPi = std::acos(-1.0);
+
+BiquadCoefficients normalized(double b0, double b1, double b2, double a0, double a1, double a2)
+{
+    BiquadCoefficients c;
+    c.b0 = static_cast<float>(b0 / a0);
+    c.b1 = static_cast<float>(b1 / a0);
+    c.b2 = static_cast<float>(b2 / a0);
+    c.a1 = static_cast<float>(a1 / a0);
+    c.a2 = static_cast<float>(a2 / a0);
+    return c;
+}
+
+// Bilinear transform of (B0 s^2 + B1 s + B2) / (A0 s^2 + A1 s + A2).
+BiquadCoefficients bilinear(double sampleRate, double B0, double B1, double B2, double A0, double A1, double A2)
+{
+    const double k = 2.0 * sampleRate;
+    const double k2 = k * k;
+    return normalized(B0 * k2 + B1 * k + B2, 2.0 * B2 - 2.0 * B0 * k2, B0 * k2 - B1 * k + B2,
+        A0 * k2 + A1 * k + A2, 2.0 * A2 - 2.0 * A0 * k2, A0 * k2 - A1 * k + A2);
+}
+
+// Analog pole frequency pre-warped so it lands at the right place after the
+// bilinear transform.
+double warped(double sampleRate, double frequency)
+{
+    const double f = std::min(frequency, 0.499 * sampleRate);
+    return 2.0 * sampleRate * std::tan(kPi * f / sampleRate);
+}
+
+// Second-order low-pass with its poles placed by impulse invariance and
+// its zeros chosen so the magnitude matches the analog prototype at DC and
+// at the corner (Vicanek, "Matched Second Order Digital Filters"). Unlike
+// the bilinear transform it does not force a zero at Nyquist, so a corner
+// near the top of the band keeps its analog shape.
+BiquadCoefficients matchedLowPass(double sampleRate, double frequency, double q)
+{
+    const double w0 = 2.0 * kPi * frequency / sampleRate;
+    const double zeta = 0.5 / q;
+    const double p = std::exp(-zeta * w0);
+    const double swing = (zeta <= 1.0) ? std::cos(std::sqrt(1.0 - zeta * zeta) * w0)
+                                       : std::cosh(std::sqrt(zeta * zeta - 1.0) * w0);
+    const double a1 = -2.0 * p * swing;
+    const double a2 = p * p;
+
+    const double A0 = (1.0 + a1 + a2) * (1.0 + a1 + a2);
+    const double A1 = (1.0 - a1 + a2) * (1.0 - a1 + a2);
+    const double A2 = -4.0 * a2;
+    const double phi1 = std::sin(0.5 * w0) * std::sin(0.5 * w0);
+    const double phi0 = 1.0 - phi1;
+    const double phi2 = 4.0 * phi0 * phi1;
+    const double R1 = (A0 * phi0 + A1 * phi1 + A2 * phi2) * q * q;
+    const double B1 = std::max(0.0, (R1 - A0 * phi0) / phi1);
+    const double b0 = 0.5 * (std::sqrt(A0) + std::sqrt(B1));
+    return normalized(b0, std::sqrt(A0) - b0, 0.0, 1.0, a1, a2);
+}
+
+void normalizeAt(std::vector<BiquadCoefficients> &sections, double sampleRate, double frequency)
+{
+    double gain = 1.0;
+    for (const auto &section : sections) {
+        gain *= section.magnitudeAt(sampleRate, frequency);
+    }
+    if (gain > 0.0 && !sections.empty()) {
+        const float scale = static_cast<float>(1.0 / gain);
+        sections.front().b0 *= scale;
+        sections.front().b1 *= scale;
+        sections.front().b2 *= scale;
+    }
+}
+
+float flushDenormal(float value)
+{
+    return (std::fabs(value) < 1e-30f) ? 0.0f : value;
+}
+} // namespace
+
+BiquadCoefficients BiquadCoefficients::lowPass(double sampleRate, double frequency, double q)
+{
+    const double w0 = 2.0 * kPi * std::min(frequency, 0.49 * sampleRate) / sampleRate;
+    const double alpha = std::sin(w0) / (2.0 * q);
+    const double c = std::cos(w0);
+    return normalized((1.0 - c) / 2.0, 1.0 - c, (1.0 - c) / 2.0, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+}
+
+BiquadCoefficients BiquadCoefficients::highPass(double sampleRate, double frequency, double q)
+{
+    const double w0 = 2.0 * kPi * std::min(frequency, 0.49 * sampleRate) / sampleRate;
+    const double alpha = std::sin(w0) / (2.0 * q);
+    const double c = std::cos(w0);
+    return normalized((1.0 + c) / 2.0, -(1.0 + c), (1.0 + c) / 2.0, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+}
+
+BiquadCoefficients BiquadCoefficients::notch(double sampleRate, double frequency, double q)
+{
+    const double w0 = 2.0 * kPi * std::min(frequency, 0.49 * sampleRate) / sampleRate;
+    const double alpha = std::sin(w0) / (2.0 * q);
+    const double c = std::cos(w0);
+    return normalized(1.0, -2.0 * c, 1.0, 1.0 + alpha, -2.0 * c, 1.0 - alpha);
+}
+
+double BiquadCoefficients::magnitudeAt(double sampleRate, double frequency) const
+{
+    const std::complex<double> z1 = std::polar(1.0, -2.0 * kPi * frequency / sampleRate);
+    const std::complex<double> z2 = z1 * z1;
+    const std::complex<double> num = static_cast<double>(b0) + static_cast<double>(b1) * z1 + static_cast<double>(b2) * z2;
+    const std::complex<double> den = 1.0 + static_cast<double>(a1) * z1 + static_cast<double>(a2) * z2;
+    return std::abs(num / den);
+}
+
+BiquadCascade::BiquadCascade(std::vector<BiquadCoefficients> sections)
+    : m_sections(std::move(sections))
+{
+}
+
+void BiquadCascade::prepare(int channels)
+{
+    m_channels = channels;
+    m_groups = (channels + kLanes - 1) / kLanes;
+    m_state.assign(static_cast<size_t>(m_groups) * m_sections.size(), LaneState{});
+}
+
+void BiquadCascade::process(float *interleaved, int frames)
+{
+    const int sectionCount = static_cast<int>(m_sections.size());
+    for (int group = 0; group < m_groups; ++group) {
+        const int firstChannel = group * kLanes;
+        const int lanes = std::min(kLanes, m_channels - firstChannel);
+        LaneState *state = m_state.data() + static_cast<size_t>(group) * sectionCount;
+
+        for (int frame = 0; frame < frames; ++frame) {
+            float *samples = interleaved + static_cast<size_t>(frame) * m_channels + firstChannel;
+            float x[kLanes] = {};
+            for (int l = 0; l < lanes; ++l) {
+                x[l] = samples[l];
+            }
+
+            for (int s = 0; s < sectionCount; ++s) {
+                const BiquadCoefficients &c = m_sections[s];
+                LaneState &z = state[s];
+                for (int l = 0; l < kLanes; ++l) {
+                    const float y = c.b0 * x[l] + z.z1[l];
+                    z.z1[l] = c.b1 * x[l] - c.a1 * y + z.z2[l];
+                    z.z2[l] = c.b2 * x[l] - c.a2 * y;
+                    x[l] = y;
+                }
+            }
+
+            for (int l = 0; l < lanes; ++l) {
+                samples[l] = x[l];
+            }
+        }
+
+        for (int s = 0; s < sectionCount; ++s) {
+            for (int l = 0; l < kLanes; ++l) {
+                state[s].z1[l] = flushDenormal(state[s].z1[l]);
+                state[s].z2[l] = flushDenormal(state[s].z2[l]);
+            }
+        }
+    }
+}
+
+void BiquadCascade::reset()
+{
+    std::fill(m_state.begin(), m_state.end(), LaneState{});
+}
+
+FirFilter::FirFilter(std::vector<float> kernel)
+    : m_kernel(std::move(kernel))
+{
+    if (m_kernel.empty()) {
+        m_kernel.push_back(1.0f);
+    }
+
+    const int taps = static_cast<int>(m_kernel.size());
+    if (taps <= kDirectTaps) {
+        return;
+    }
+
+    m_blockSize = std::max(64, Fft::nextPow2((taps + kMaxPartitions - 1) / kMaxPartitions));
+    m_partitions = (taps + m_blockSize - 1) / m_blockSize;
+    m_fft.setSize(2 * m_blockSize);
+
+    m_kernelSpectra.resize(m_partitions);
+    for (int p = 0; p < m_partitions; ++p) {
+        auto &spectrum = m_kernelSpectra[p];
+        spectrum.assign(2 * m_blockSize, std::complex<float>());
+        for (int i = 0; i < m_blockSize; ++i) {
+            const int tap = p * m_blockSize + i;
+            if (tap < taps) {
+                spectrum[i] = std::complex<float>(m_kernel[tap], 0.0f);
+            }
+        }
+        m_fft.forward(spectrum.data());
+    }
+}
+
+std::vector<float> FirFilter::windowedSincLowPass(double sampleRate, double cutoff, int taps)
+{
+    taps = std::max(3, taps | 1);
+    std::vector<float> kernel(taps);
+    const double fc = std::min(cutoff, 0.49 * sampleRate) / sampleRate;
+    const int mid = taps / 2;
+    double sum = 0.0;
+    for (int i = 0; i < taps; ++i) {
+        const int n = i - mid;
+        const double sinc = (n == 0) ? 2.0 * fc : std::sin(2.0 * kPi * fc * n) / (kPi * n);
+        const double phase = 2.0 * kPi * i / (taps - 1);
+        const double window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        kernel[i] = static_cast<float>(sinc * window);
+        sum += kernel[i];
+    }
+    for (float &tap : kernel) {
+        tap = static_cast<float>(tap / sum);
+    }
+    return kernel;
+}
+
+int FirFilter::latency() const
+{
+    return m_blockSize;
+}
+
+void FirFilter::prepare(int channels)
+{
+    m_channels = channels;
+    const int taps = static_cast<int>(m_kernel.size());
+
+    if (m_blockSize == 0) {
+        m_history.assign(static_cast<size_t>(channels) * taps * 2, 0.0f);
+        m_fill = 0;
+        return;
+    }
+
+    m_pairs.resize((channels + 1) / 2);
+    for (PairState &pair : m_pairs) {
+        pair.input.assign(2 * m_blockSize, std::complex<float>());
+        pair.output.assign(m_blockSize, std::complex<float>());
+        pair.scratch.assign(2 * m_blockSize, std::complex<float>());
+        pair.spectra.assign(m_partitions, std::vector<std::complex<float>>(2 * m_blockSize));
+        pair.newest = 0;
+    }
+    m_fill = 0;
+}
+
+void FirFilter::process(float *interleaved, int frames)
+{
+    if (m_blockSize == 0) {
+        processDirect(interleaved, frames);
+    } else {
+        processPartitioned(interleaved, frames);
+    }
+}
+
+void FirFilter::reset()
+{
+    prepare(m_channels);
+}
+
+void FirFilter::processDirect(float *interleaved, int frames)
+{
+    const int taps = static_cast<int>(m_kernel.size());
+    for (int c = 0; c < m_channels; ++c) {
+        float *history = m_history.data() + static_cast<size_t>(c) * taps * 2;
+        int pos = m_fill;
+        for (int frame = 0; frame < frames; ++frame) {
+            float &sample = interleaved[static_cast<size_t>(frame) * m_channels + c];
+            pos = (pos == 0) ? taps - 1 : pos - 1;
+            history[pos] = sample;
+            history[pos + taps] = sample;
+
+            float acc = 0.0f;
+            const float *x = history + pos;
+            for (int k = 0; k < taps; ++k) {
+                acc += m_kernel[k] * x[k];
+            }
+            sample = acc;
+        }
+        if (c == m_channels - 1) {
+            m_fill = pos;
+        }
+    }
+}
+
+void FirFilter::processPartitioned(float *interleaved, int frames)
+{
+    const int pairs = static_cast<int>(m_pairs.size());
+    for (int frame = 0; frame < frames; ++frame) {
+        float *samples = interleaved + static_cast<size_t>(frame) * m_channels;
+        for (int p = 0; p < pairs; ++p) {
+            PairState &pair = m_pairs[p];
+            const int left = 2 * p;
+            const bool hasRight = left + 1 < m_channels;
+            const std::complex<float> out = pair.output[m_fill];
+            pair.input[m_blockSize + m_fill] = std::complex<float>(samples[left], hasRight ? samples[left + 1] : 0.0f);
+            samples[left] = out.real();
+            if (hasRight) {
+                samples[left + 1] = out.imag();
+            }
+        }
+
+        if (++m_fill == m_blockSize) {
+            for (int p = 0; p < pairs; ++p) {
+                convolveBlock(p);
+            }
+            m_fill = 0;
+        }
+    }
+}
+
+void FirFilter::convolveBlock(int index)
+{
+    PairState &pair = m_pairs[index];
+    const int n = 2 * m_blockSize;
+
+    pair.newest = (pair.newest + 1) % m_partitions;
+    std::vector<std::complex<float>> &spectrum = pair.spectra[pair.newest];
+    std::copy(pair.input.begin(), pair.input.end(), spectrum.begin());
+    m_fft.forward(spectrum.data());
+
+    std::fill(pair.scratch.begin(), pair.scratch.end(), std::complex<float>());
+    for (int p = 0; p < m_partitions; ++p) {
+        const std::complex<float> *x = pair.spectra[(pair.newest - p + m_partitions) % m_partitions].data();
+        const std::complex<float> *h = m_kernelSpectra[p].data();
+        std::complex<float> *acc = pair.scratch.data();
+        for (int i = 0; i < n; ++i) {
+            const float re = x[i].real() * h[i].real() - x[i].imag() * h[i].imag();
+            const float im = x[i].real() * h[i].imag() + x[i].imag() * h[i].real();
+            acc[i] += std::complex<float>(re, im);
+        }
+    }
+    m_fft.inverse(pair.scratch.data());
+
+    std::copy(pair.scratch.begin() + m_blockSize, pair.scratch.end(), pair.output.begin());
+    std::copy(pair.input.begin() + m_blockSize, pair.input.end(), pair.input.begin());
+}
+
+std::vector<BiquadCoefficients> FilterChain::aWeighting(double sampleRate)
+{
+    const double w1 = warped(sampleRate, 20.598997);
+    const double w2 = warped(sampleRate, 107.65265);
+    const double w3 = warped(sampleRate, 737.86223);
+
+    std::vector<BiquadCoefficients> sections;
+    sections.push_back(bilinear(sampleRate, 1.0, 0.0, 0.0, 1.0, 2.0 * w1, w1 * w1));
+    sections.push_back(bilinear(sampleRate, 1.0, 0.0, 0.0, 1.0, w2 + w3, w2 * w3));
+    sections.push_back(matchedLowPass(sampleRate, 12194.217, 0.5));
+    normalizeAt(sections, sampleRate, 1000.0);
+    return sections;
+}
+
+std::vector<BiquadCoefficients> FilterChain::cWeighting(double sampleRate)
+{
+    const double w1 = warped(sampleRate, 20.598997);
+
+    std::vector<BiquadCoefficients> sections;
+    sections.push_back(bilinear(sampleRate, 1.0, 0.0, 0.0, 1.0, 2.0 * w1, w1 * w1));
+    sections.push_back(matchedLowPass(sampleRate, 12194.217, 0.5));
+    normalizeAt(sections, sampleRate, 1000.0);
+    return sections;
+}
+
+void FilterChain::clear()
+{
+    m_stages.clear();
+    m_channels = 0;
+}
+
+void FilterChain::addBiquads(std::vector<BiquadCoefficients> sections)
+{
+    m_stages.push_back(std::make_unique<BiquadCascade>(std::move(sections)));
+    m_channels = 0;
+}
+
+void FilterChain::addFir(std::vector<float> kernel)
+{
+    m_stages.push_back(std::make_unique<FirFilter>(std::move(kernel)));
+    m_channels = 0;
+}
+
+void FilterChain::setPreset(Preset preset, int sampleRate)
+{
+    clear();
+    if (sampleRate <= 0) {
+        return;
+    }
+
+    switch (preset) {
+    case PresetHighPass20:
+        addBiquads({BiquadCoefficients::highPass(sampleRate, 20.0, 0.5411961), BiquadCoefficients::highPass(sampleRate, 20.0, 1.3065630)});
+        break;
+    case PresetLowPass20k:
+        addBiquads({BiquadCoefficients::lowPass(sampleRate, 20000.0, 0.5411961), BiquadCoefficients::lowPass(sampleRate, 20000.0, 1.3065630)});
+        break;
+    case PresetNotch50:
+        addBiquads({BiquadCoefficients::notch(sampleRate, 50.0), BiquadCoefficients::notch(sampleRate, 150.0)});
+        break;
+    case PresetNotch60:
+        addBiquads({BiquadCoefficients::notch(sampleRate, 60.0), BiquadCoefficients::notch(sampleRate, 180.0)});
+        break;
+    case PresetAWeighting:
+        addBiquads(aWeighting(sampleRate));
+        break;
+    case PresetCWeighting:
+        addBiquads(cWeighting(sampleRate));
+        break;
+    case PresetFirLowPass1k:
+        addFir(FirFilter::windowedSincLowPass(sampleRate, 1000.0, sampleRate / 20 + 1));
+        break;
+    case PresetNone:
+    default:
+        break;
+    }
+}
+
+int FilterChain::latencyFrames() const
+{
+    int frames = 0;
+    for (const auto &stage : m_stages) {
+        frames += stage->latency();
+    }
+    return frames;
+}
+
+void FilterChain::process(float *interleaved, int frames, int channels)
+{
+    if (m_stages.empty() || frames <= 0 || channels <= 0) {
+        return;
+    }
+
+    if (channels != m_channels) {
+        m_channels = channels;
+        for (auto &stage : m_stages) {
+            stage->prepare(m_channels);
+        }
+    }
+
+    for (auto &stage : m_stages) {
+        stage->process(interleaved, frames);
+    }
+}
+
+void FilterChain::reset()
+{
+    for (auto &stage : m_stages) {
+        stage->reset();
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "fft.h"
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+struct BiquadCoefficients {
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+
+    static BiquadCoefficients lowPass(double sampleRate, double frequency, double q = 0.70710678);
+    static BiquadCoefficients highPass(double sampleRate, double frequency, double q = 0.70710678);
+    static BiquadCoefficients notch(double sampleRate, double frequency, double q = 10.0);
+
+    double magnitudeAt(double sampleRate, double frequency) const;
+};
+
+class FilterStage
+{
+public:
+    virtual ~FilterStage() = default;
+
+    // Processes interleaved frames in place. Stages allocate in prepare(),
+    // never in process(), and accept any block length.
+    virtual void prepare(int channels) = 0;
+    virtual void process(float *interleaved, int frames) = 0;
+    virtual void reset() = 0;
+    // Frames by which the output trails the input, on top of the response
+    // of the filter itself.
+    virtual int latency() const { return 0; }
+};
+
+// Cascade of transposed direct form II biquads. Channels are processed side
+// by side in groups of kLanes so the per-section arithmetic maps onto SIMD
+// registers.
+class BiquadCascade : public FilterStage
+{
+public:
+    static constexpr int kLanes = 4;
+
+    explicit BiquadCascade(std::vector<BiquadCoefficients> sections);
+
+    void prepare(int channels) override;
+    void process(float *interleaved, int frames) override;
+    void reset() override;
+
+private:
+    struct alignas(16) LaneState {
+        float z1[kLanes];
+        float z2[kLanes];
+    };
+
+    std::vector<BiquadCoefficients> m_sections;
+    std::vector<LaneState> m_state;
+    int m_channels = 0;
+    int m_groups = 0;
+};
+
+// FIR filter. Short kernels run directly; long ones use uniformly
+// partitioned overlap-save convolution, with the partition size growing
+// with the kernel so the number of partitions (and the per-sample cost)
+// stays bounded. Two channels share one complex FFT, one in the real part
+// and one in the imaginary part. Long kernels add one partition of latency.
+class FirFilter : public FilterStage
+{
+public:
+    explicit FirFilter(std::vector<float> kernel);
+
+    static std::vector<float> windowedSincLowPass(double sampleRate, double cutoff, int taps);
+
+    int latency() const override;
+
+    void prepare(int channels) override;
+    void process(float *interleaved, int frames) override;
+    void reset() override;
+
+private:
+    static constexpr int kDirectTaps = 64;
+    static constexpr int kMaxPartitions = 16;
+
+    void processDirect(float *interleaved, int frames);
+    void processPartitioned(float *interleaved, int frames);
+    void convolveBlock(int pair);
+
+    std::vector<float> m_kernel;
+    int m_channels = 0;
+
+    // Direct form history, newest sample last, per channel.
+    std::vector<float> m_history;
+
+    // Partitioned convolution.
+    int m_blockSize = 0;
+    int m_partitions = 0;
+    Fft m_fft;
+    std::vector<std::vector<std::complex<float>>> m_kernelSpectra;
+    struct PairState {
+        std::vector<std::complex<float>> input;                    // 2B: previous block + current block
+        std::vector<std::vector<std::complex<float>>> spectra;    // frequency-domain delay line
+        std::vector<std::complex<float>> output;                   // last B outputs
+        std::vector<std::complex<float>> scratch;
+        int newest = 0;
+    };
+    std::vector<PairState> m_pairs;
+    int m_fill = 0;
+};
+
+class FilterChain
+{
+public:
+    enum Preset {
+        PresetNone = 0,
+        PresetHighPass20 = 1,
+        PresetLowPass20k = 2,
+        PresetNotch50 = 3,
+        PresetNotch60 = 4,
+        PresetAWeighting = 5,
+        PresetCWeighting = 6,
+        PresetFirLowPass1k = 7
+    };
+
+    static std::vector<BiquadCoefficients> aWeighting(double sampleRate);
+    static std::vector<BiquadCoefficients> cWeighting(double sampleRate);
+
+    void clear();
+    void addBiquads(std::vector<BiquadCoefficients> sections);
+    void addFir(std::vector<float> kernel);
+    void setPreset(Preset preset, int sampleRate);
+
+    bool isEmpty() const { return m_stages.empty(); }
+    int latencyFrames() const;
+
+    // Stages are re-prepared (and their state cleared) only when the channel
+    // count changes; steady-state calls do not allocate.
+    void process(float *interleaved, int frames, int channels);
+    void reset();
+
+private:
+    std::vector<std::unique_ptr<FilterStage>> m_stages;
+    int m_channels = 0;
+};
@@ -0,0 +1,44 @@
+#include "framepublisher.h"
+
+FramePublisher::FramePublisher(QObject *parent)
+    : QObject(parent)
+{
+}
+
+bool FramePublisher::start(const QString &name)
+{
+    std::string error;
+    if (!m_ring.create(name.toStdString(), 128, 128 * 1024, &error)) {
+        emit statusChanged(QStringLiteral("Frame publishing failed: %1").arg(QString::fromStdString(error)));
+        return false;
+    }
+    return true;
+}
+
+void FramePublisher::stop()
+{
+    m_ring.close();
+}
+
+void FramePublisher::publishSamples(const QVector<float> &interleaved, int channels, int sampleRate,
+    qint64 firstFrame, qint64 timestampNs)
+{
+    if (!m_ring.isOpen() || channels <= 0) {
+        return;
+    }
+
+    const int frames = interleaved.size() / channels;
+    m_ring.publish(SharedFrame::KindSamples, channels, frames, sampleRate, static_cast<uint64_t>(firstFrame),
+        interleaved.constData(), static_cast<uint64_t>(timestampNs));
+}
+
+void FramePublisher::publishSpectrum(const QVector<float> &bins, int sampleRate, qint64 firstFrame,
+    qint64 timestampNs)
+{
+    if (!m_ring.isOpen()) {
+        return;
+    }
+
+    m_ring.publish(SharedFrame::KindSpectrum, 1, bins.size(), sampleRate, static_cast<uint64_t>(firstFrame),
+        bins.constData(), static_cast<uint64_t>(timestampNs));
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include "sharedframering.h"
+
+class FramePublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FramePublisher(QObject *parent = nullptr);
+
+    bool start(const QString &name = QString::fromLatin1(SharedFrame::kDefaultName));
+    void stop();
+    bool isPublishing() const { return m_ring.isOpen(); }
+
+public slots:
+    // firstFrame and timestampNs place the block on the capture timeline,
+    // so readers see dropped frames as a jump in the sample index.
+    void publishSamples(const QVector<float> &interleaved, int channels, int sampleRate, qint64 firstFrame,
+        qint64 timestampNs);
+    void publishSpectrum(const QVector<float> &bins, int sampleRate, qint64 firstFrame, qint64 timestampNs);
+
+signals:
+    void statusChanged(const QString &text);
+
+private:
+    SharedFrameRing m_ring;
+};
@@ -0,0 +1,210 @@
+#include "loopbackanalyzer.h"
+
+#include "fft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring>
+
+namespace {
+constexpr int kResponseFftSize = 8192;
+} // namespace
+
+void LoopbackAnalyzer::configure(int sampleRate, int length)
+{
+    if (sampleRate > 0) {
+        m_sampleRate = sampleRate;
+    }
+    const int frames = std::max(1024, length);
+    m_emitted.assign(frames, 0.0f);
+    m_captured.assign(frames, 0.0f);
+    reset();
+}
+
+void LoopbackAnalyzer::reset()
+{
+    m_fill = 0;
+    m_result = LoopbackResult();
+}
+
+bool LoopbackAnalyzer::process(const float *emitted, const float *captured, int count)
+{
+    if (isComplete()) {
+        return false;
+    }
+
+    const int take = std::min(count, length() - m_fill);
+    std::memcpy(m_emitted.data() + m_fill, emitted, sizeof(float) * take);
+    std::memcpy(m_captured.data() + m_fill, captured, sizeof(float) * take);
+    m_fill += take;
+    if (!isComplete()) {
+        return false;
+    }
+
+    m_result = analyze(m_emitted.data(), m_captured.data(), length(), m_sampleRate);
+    if (m_result.valid && m_outputLead != 0.0) {
+        m_result.latencySamples -= m_outputLead;
+        m_result.latencyMs = 1000.0 * m_result.latencySamples / m_sampleRate;
+        m_result.response.delaySamples -= m_outputLead;
+        m_result.response.delayMs = 1000.0 * m_result.response.delaySamples / m_sampleRate;
+    }
+    return true;
+}
+
+LoopbackResult LoopbackAnalyzer::analyze(const float *emitted, const float *captured, int count, int sampleRate)
+{
+    LoopbackResult result;
+    result.sampleRate = sampleRate;
+    if (count < 1024 || sampleRate <= 0) {
+        return result;
+    }
+
+    // Linear cross-correlation through a zero-padded FFT. Both real
+    // signals share one complex transform (z = e + i*c).
+    const int n = Fft::nextPow2(2 * count);
+    Fft fft(n);
+    std::vector<std::complex<float>> data(n);
+    double emittedEnergy = 0.0;
+    double capturedEnergy = 0.0;
+    for (int i = 0; i < count; ++i) {
+        data[i] = std::complex<float>(emitted[i], captured[i]);
+        emittedEnergy += static_cast<double>(emitted[i]) * emitted[i];
+        capturedEnergy += static_cast<double>(captured[i]) * captured[i];
+    }
+    if (emittedEnergy <= 0.0 || capturedEnergy <= 0.0) {
+        return result;
+    }
+    fft.forward(data.data());
+
+    std::vector<std::complex<float>> cross(n);
+    for (int k = 0; k < n; ++k) {
+        const std::complex<float> z = data[k];
+        const std::complex<float> zc = std::conj(data[(n - k) & (n - 1)]);
+        const std::complex<float> e = 0.5f * (z + zc);
+        const std::complex<float> d = 0.5f * (z - zc);
+        const std::complex<float> c(d.imag(), -d.real());
+        cross[k] = std::conj(e) * c;
+    }
+    fft.inverse(cross.data());
+
+    // Only non-negative lags up to half the recording: the return cannot
+    // precede the emission, and longer lags leave too little overlap.
+    const int maxLag = count / 2;
+    int peak = 0;
+    for (int lag = 1; lag < maxLag; ++lag) {
+        if (std::fabs(cross[lag].real()) > std::fabs(cross[peak].real())) {
+            peak = lag;
+        }
+    }
+
+    const double a = (peak > 0) ? std::fabs(cross[peak - 1].real()) : 0.0;
+    const double b = std::fabs(cross[peak].real());
+    const double c = std::fabs(cross[peak + 1].real());
+    const double denominator = a - 2.0 * b + c;
+    const double fraction = (peak > 0 && denominator != 0.0) ? 0.5 * (a - c) / denominator : 0.0;
+
+    result.valid = true;
+    result.latencySamples = peak + fraction;
+    result.latencyMs = 1000.0 * result.latencySamples / sampleRate;
+    result.correlation = b / std::sqrt(emittedEnergy * capturedEnergy);
+
+    TransferAnalyzer transfer;
+    const int overlap = count - peak;
+    transfer.configure(sampleRate, std::min(kResponseFftSize, Fft::nextPow2(overlap / 8 + 1)));
+    transfer.setAverages(0);
+    transfer.process(emitted, captured + peak, overlap);
+    result.response = transfer.result();
+    result.response.delaySamples += peak;
+    result.response.delayMs = 1000.0 * result.response.delaySamples / sampleRate;
+    return result;
+}
+
+void LoopbackSimulator::configure(int sampleRate, int delayFrames)
+{
+    if (sampleRate > 0) {
+        m_sampleRate = sampleRate;
+    }
+    m_delay.assign(std::max(0, delayFrames), 0.0f);
+    reset();
+}
+
+void LoopbackSimulator::setResponse(std::vector<BiquadCoefficients> sections)
+{
+    m_sections = sections;
+    m_filter.clear();
+    if (!m_sections.empty()) {
+        m_filter.addBiquads(std::move(sections));
+    }
+}
+
+void LoopbackSimulator::reset()
+{
+    std::fill(m_delay.begin(), m_delay.end(), 0.0f);
+    m_position = 0;
+    m_noiseState = 1;
+    m_filter.reset();
+}
+
+double LoopbackSimulator::magnitudeAt(double hz) const
+{
+    double magnitude = std::fabs(m_gain);
+    for (const BiquadCoefficients &section : m_sections) {
+        magnitude *= section.magnitudeAt(m_sampleRate, hz);
+    }
+    return magnitude;
+}
+
+double LoopbackSimulator::expectedLatency() const
+{
+    LoopbackSimulator response;
+    response.configure(m_sampleRate, 0);
+    response.setResponse(m_sections);
+
+    const int length = 4096;
+    std::vector<float> impulse(length, 0.0f);
+    std::vector<float> output(length);
+    impulse[0] = 1.0f;
+    response.process(impulse.data(), output.data(), length);
+
+    int peak = 0;
+    for (int i = 1; i < length - 1; ++i) {
+        if (std::fabs(output[i]) > std::fabs(output[peak])) {
+            peak = i;
+        }
+    }
+    double fraction = 0.0;
+    if (peak > 0) {
+        const double a = std::fabs(output[peak - 1]);
+        const double b = std::fabs(output[peak]);
+        const double c = std::fabs(output[peak + 1]);
+        const double denominator = a - 2.0 * b + c;
+        fraction = (denominator != 0.0) ? 0.5 * (a - c) / denominator : 0.0;
+    }
+    return static_cast<double>(m_delay.size()) + peak + fraction;
+}
+
+void LoopbackSimulator::process(const float *output, float *input, int frames)
+{
+    const int length = static_cast<int>(m_delay.size());
+    for (int i = 0; i < frames; ++i) {
+        if (length == 0) {
+            input[i] = output[i];
+            continue;
+        }
+        input[i] = m_delay[m_position];
+        m_delay[m_position] = output[i];
+        m_position = (m_position + 1) % length;
+    }
+
+    m_filter.process(input, frames, 1);
+
+    for (int i = 0; i < frames; ++i) {
+        float noise = 0.0f;
+        if (m_noise > 0.0f) {
+            m_noiseState = m_noiseState * 1664525u + 1013904223u;
+            noise = m_noise * (static_cast<float>(m_noiseState >> 8) / 8388608.0f - 1.0f);
+        }
+        input[i] = m_gain * input[i] + noise;
+    }
+}
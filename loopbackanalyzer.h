@@ -0,0 +1,93 @@
+#pragma once
+
+#include "filterchain.h"
+#include "transferanalyzer.h"
+
+#include <cstdint>
+#include <vector>
+
+struct LoopbackResult {
+    bool valid = false;
+    int sampleRate = 0;
+    double latencySamples = 0.0;
+    double latencyMs = 0.0;
+    // Correlation peak normalised by both signal energies (1 = identical
+    // shape). A low value means the latency is not trustworthy, e.g. with
+    // a pure sine.
+    double correlation = 0.0;
+    // Response of the return relative to the emitted signal after the
+    // latency has been removed; its delay fields hold the total latency.
+    TransferResult response;
+};
+
+// Round-trip measurement: the emitted and captured streams are recorded in
+// lockstep, the latency is the peak of their FFT cross-correlation, and the
+// frequency response comes from the delay-compensated pair.
+class LoopbackAnalyzer
+{
+public:
+    static constexpr int kDefaultLength = 1 << 17;
+
+    // `length` frames of each stream are recorded; latencies up to half of
+    // that can be measured.
+    void configure(int sampleRate, int length = kDefaultLength);
+    void reset();
+
+    int sampleRate() const { return m_sampleRate; }
+    int length() const { return static_cast<int>(m_emitted.size()); }
+    bool isComplete() const { return m_fill == length(); }
+
+    // Frames by which the host scheduled the emitted stream late relative
+    // to the captured one (playback write-ahead plus capture age). It is
+    // part of the measured offset but not of the device round trip, so
+    // the result excludes it.
+    void setOutputLead(double frames) { m_outputLead = frames; }
+    double outputLead() const { return m_outputLead; }
+
+    // Returns true once, when the recording fills up and result() has been
+    // computed. Later calls are ignored until reset().
+    bool process(const float *emitted, const float *captured, int count);
+    const LoopbackResult &result() const { return m_result; }
+
+    static LoopbackResult analyze(const float *emitted, const float *captured, int count, int sampleRate);
+
+private:
+    int m_sampleRate = 48000;
+    int m_fill = 0;
+    double m_outputLead = 0.0;
+    std::vector<float> m_emitted;
+    std::vector<float> m_captured;
+    LoopbackResult m_result;
+};
+
+// Stand-in for a sound card whose output is cabled to its input, for
+// exercising the generator and loopback analysis without audio hardware.
+// Applies a known delay, a biquad response, a gain and optional noise.
+class LoopbackSimulator
+{
+public:
+    void configure(int sampleRate, int delayFrames);
+    void setResponse(std::vector<BiquadCoefficients> sections);
+    void setGain(float gain) { m_gain = gain; }
+    void setNoiseLevel(float level) { m_noise = level; }
+    void reset();
+
+    int delayFrames() const { return static_cast<int>(m_delay.size()); }
+    // Magnitude of the injected response (gain included) at `hz`.
+    double magnitudeAt(double hz) const;
+    // Where a broadband cross-correlation should peak: the delay plus the
+    // peak of the injected response's impulse response.
+    double expectedLatency() const;
+
+    void process(const float *output, float *input, int frames);
+
+private:
+    int m_sampleRate = 48000;
+    float m_gain = 1.0f;
+    float m_noise = 0.0f;
+    uint32_t m_noiseState = 1;
+    std::vector<float> m_delay;
+    int m_position = 0;
+    std::vector<BiquadCoefficients> m_sections;
+    FilterChain m_filter;
+};
@@ -1,11 +1,16 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QElapsedTimer>
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer launchTimer;
+    launchTimer.start();
+
     QApplication app(argc, argv);
     MainWindow window;
+    window.setLaunchTimer(launchTimer);
     window.show();
     return app.exec();
 }
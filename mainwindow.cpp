@@ -1,27 +1,47 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 
+#include "bandwidget.h"
+#include "framepublisher.h"
+#include "measurementpanel.h"
+#include "pitchwidget.h"
 #include "scopewidget.h"
 #include "spectrumwidget.h"
+#include "transferwidget.h"
 
+#include <QAction>
+#include <QCheckBox>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QFileDialog>
+#include <QLabel>
+#include <QSignalBlocker>
 #include <QStatusBar>
+#include <QTimer>
+
+#include <cmath>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
 {
+    m_launchTimer.start();
     ui->setupUi(this);
 
-    const QStringList sources = ui->scopeWidget->deviceNames();
-    ui->sourceCombo->addItems(sources);
-
-    const QStringList outputs = ui->scopeWidget->outputDeviceNames();
-    ui->outputCombo->addItems(outputs);
-
     ui->channelCombo->addItem(QStringLiteral("Stereo"), ScopeWidget::ChannelStereo);
     ui->channelCombo->addItem(QStringLiteral("Left"), ScopeWidget::ChannelLeft);
     ui->channelCombo->addItem(QStringLiteral("Right"), ScopeWidget::ChannelRight);
 
+    ui->filterCombo->addItem(QStringLiteral("None"), FilterChain::PresetNone);
+    ui->filterCombo->addItem(QStringLiteral("High-pass 20 Hz"), FilterChain::PresetHighPass20);
+    ui->filterCombo->addItem(QStringLiteral("Low-pass 20 kHz"), FilterChain::PresetLowPass20k);
+    ui->filterCombo->addItem(QStringLiteral("Notch 50 Hz"), FilterChain::PresetNotch50);
+    ui->filterCombo->addItem(QStringLiteral("Notch 60 Hz"), FilterChain::PresetNotch60);
+    ui->filterCombo->addItem(QStringLiteral("A-weighting"), FilterChain::PresetAWeighting);
+    ui->filterCombo->addItem(QStringLiteral("C-weighting"), FilterChain::PresetCWeighting);
+    ui->filterCombo->addItem(QStringLiteral("FIR low-pass 1 kHz"), FilterChain::PresetFirLowPass1k);
+
     connect(ui->sourceCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
         ui->scopeWidget->setDeviceIndex(index);
     });
@@ -35,6 +55,87 @@ MainWindow::MainWindow(QWidget *parent)
         ui->scopeWidget->setChannelMode(static_cast<ScopeWidget::ChannelMode>(mode));
     });
 
+    ui->bandsCombo->addItem(QStringLiteral("1/1 octave"), 1);
+    ui->bandsCombo->addItem(QStringLiteral("1/3 octave"), 3);
+    ui->bandsCombo->addItem(QStringLiteral("1/12 octave"), 12);
+    ui->bandsCombo->setCurrentIndex(1);
+
+    ui->integrationCombo->addItem(QStringLiteral("Fast"), OctaveBandAnalyzer::IntegrationFast);
+    ui->integrationCombo->addItem(QStringLiteral("Slow"), OctaveBandAnalyzer::IntegrationSlow);
+    ui->integrationCombo->addItem(QStringLiteral("Leq"), OctaveBandAnalyzer::IntegrationLeq);
+
+    connect(ui->bandsCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
+        ui->bandWidget->setBandsPerOctave(ui->bandsCombo->itemData(index).toInt());
+    });
+
+    connect(ui->integrationCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
+        const int integration = ui->integrationCombo->itemData(index).toInt();
+        ui->bandWidget->setIntegration(static_cast<OctaveBandAnalyzer::Integration>(integration));
+    });
+
+    ui->cqtBinsCombo->addItem(QStringLiteral("12 bins/octave"), 12);
+    ui->cqtBinsCombo->addItem(QStringLiteral("24 bins/octave"), 24);
+    ui->cqtBinsCombo->addItem(QStringLiteral("36 bins/octave"), 36);
+    ui->cqtBinsCombo->setCurrentIndex(1);
+
+    connect(ui->cqtBinsCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
+        ui->pitchWidget->setBinsPerOctave(ui->cqtBinsCombo->itemData(index).toInt());
+    });
+
+    ui->averagesCombo->addItem(QStringLiteral("4"), 4);
+    ui->averagesCombo->addItem(QStringLiteral("16"), 16);
+    ui->averagesCombo->addItem(QStringLiteral("64"), 64);
+    ui->averagesCombo->addItem(QStringLiteral("Infinite"), 0);
+    ui->averagesCombo->setCurrentIndex(1);
+    ui->transferWidget->setAverages(16);
+
+    connect(ui->averagesCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
+        ui->transferWidget->setAverages(ui->averagesCombo->itemData(index).toInt());
+    });
+    connect(ui->transferResetButton, &QPushButton::clicked, ui->transferWidget, &TransferWidget::reset);
+
+    ui->generatorTypeCombo->addItem(QStringLiteral("Sine 1 kHz"), SignalGenerator::TypeSine);
+    ui->generatorTypeCombo->addItem(QStringLiteral("Multitone"), SignalGenerator::TypeMultitone);
+    ui->generatorTypeCombo->addItem(QStringLiteral("Log sweep"), SignalGenerator::TypeLogSweep);
+    ui->generatorTypeCombo->addItem(QStringLiteral("MLS"), SignalGenerator::TypeMls);
+    ui->generatorTypeCombo->setCurrentIndex(3);
+    ui->scopeWidget->setGeneratorType(SignalGenerator::TypeMls);
+    ui->scopeWidget->setGeneratorLevel(static_cast<float>(std::pow(10.0, ui->generatorLevelSpin->value() / 20.0)));
+
+    connect(ui->generatorCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        ui->scopeWidget->setGeneratorEnabled(checked);
+    });
+    connect(ui->generatorTypeCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
+        const int type = ui->generatorTypeCombo->itemData(index).toInt();
+        ui->scopeWidget->setGeneratorType(static_cast<SignalGenerator::Type>(type));
+    });
+    connect(ui->generatorLevelSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, [this](double dbfs) {
+        ui->scopeWidget->setGeneratorLevel(static_cast<float>(std::pow(10.0, dbfs / 20.0)));
+    });
+    connect(ui->loopbackButton, &QPushButton::clicked, this, [this]() {
+        if (ui->scopeWidget->startLoopbackMeasurement()) {
+            ui->loopbackLabel->setText(QStringLiteral("Measuring..."));
+        } else {
+            ui->loopbackLabel->setText(QStringLiteral("Needs capture, output and the generator running"));
+        }
+    });
+    connect(ui->scopeWidget, &ScopeWidget::loopbackFinished, this, [this](const LoopbackResult &result) {
+        if (!result.valid) {
+            ui->loopbackLabel->setText(QStringLiteral("No return signal"));
+            return;
+        }
+        ui->loopbackLabel->setText(QStringLiteral("Round trip %1 ms (%2 samples), correlation %3")
+                                       .arg(result.latencyMs, 0, 'f', 2)
+                                       .arg(result.latencySamples, 0, 'f', 1)
+                                       .arg(result.correlation, 0, 'f', 2));
+        ui->loopbackWidget->setResult(result.response);
+    });
+
+    connect(ui->filterCombo, &QComboBox::currentIndexChanged, this, [this](int index) {
+        const int preset = ui->filterCombo->itemData(index).toInt();
+        ui->scopeWidget->setFilterPreset(static_cast<FilterChain::Preset>(preset));
+    });
+
     connect(ui->timeScaleSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
         ui->scopeWidget->setTimeScaleMs(value);
     });
@@ -47,6 +148,8 @@ MainWindow::MainWindow(QWidget *parent)
         if (ui->scopeWidget->isCapturing()) {
             ui->scopeWidget->stopCapture();
             ui->startButton->setText(QStringLiteral("Start"));
+            const QSignalBlocker blocker(ui->recordSessionAction);
+            ui->recordSessionAction->setChecked(false);
         } else {
             if (ui->scopeWidget->startCapture()) {
                 ui->startButton->setText(QStringLiteral("Stop"));
@@ -54,22 +157,176 @@ MainWindow::MainWindow(QWidget *parent)
         }
     });
 
+    connect(ui->recordButton, &QPushButton::toggled, this, [this](bool checked) {
+        if (!checked) {
+            ui->scopeWidget->stopRecording();
+            return;
+        }
+        const QString path = QFileDialog::getSaveFileName(this, QStringLiteral("Record to"), QString(),
+            QStringLiteral("WAV files (*.wav)"));
+        QString error;
+        if (path.isEmpty() || !ui->scopeWidget->startRecording(path, &error)) {
+            if (!error.isEmpty()) {
+                statusBar()->showMessage(QStringLiteral("Recording failed: %1").arg(error));
+            }
+            const QSignalBlocker blocker(ui->recordButton);
+            ui->recordButton->setChecked(false);
+        }
+    });
+
+    connect(ui->recordSessionAction, &QAction::toggled, this, [this](bool checked) {
+        if (!checked) {
+            ui->scopeWidget->stopSessionRecording();
+            return;
+        }
+        const QString path = QFileDialog::getSaveFileName(this, QStringLiteral("Record session to"), QString(),
+            QStringLiteral("Capture sessions (*.svcs)"));
+        QString error;
+        if (path.isEmpty() || !ui->scopeWidget->startSessionRecording(path, &error)) {
+            if (!error.isEmpty()) {
+                statusBar()->showMessage(QStringLiteral("Session recording failed: %1").arg(error));
+            }
+            const QSignalBlocker blocker(ui->recordSessionAction);
+            ui->recordSessionAction->setChecked(false);
+        }
+    });
+
+    const auto replaySession = [this](bool realTime) {
+        const QString path = QFileDialog::getOpenFileName(this, QStringLiteral("Replay session"), QString(),
+            QStringLiteral("Capture sessions (*.svcs)"));
+        if (path.isEmpty()) {
+            return;
+        }
+        {
+            const QSignalBlocker blocker(ui->recordSessionAction);
+            ui->recordSessionAction->setChecked(false);
+        }
+        QString error;
+        if (ui->scopeWidget->startReplay(path, realTime, &error)) {
+            ui->startButton->setText(QStringLiteral("Stop"));
+        } else {
+            ui->startButton->setText(QStringLiteral("Start"));
+            statusBar()->showMessage(QStringLiteral("Replay failed: %1").arg(error));
+        }
+    };
+    connect(ui->replaySessionAction, &QAction::triggered, this, [replaySession]() {
+        replaySession(true);
+    });
+    connect(ui->replayFastAction, &QAction::triggered, this, [replaySession]() {
+        replaySession(false);
+    });
+    connect(ui->scopeWidget, &ScopeWidget::replayFinished, this, [this]() {
+        ui->startButton->setText(QStringLiteral("Start"));
+    });
+
     connect(ui->scopeWidget, &ScopeWidget::statusChanged, this, [this](const QString &text) {
         statusBar()->showMessage(text);
     });
 
+    connect(ui->scopeWidget, &ScopeWidget::devicesChanged, this, &MainWindow::updateDeviceCombos);
+
+    connect(ui->scopeWidget, &ScopeWidget::spectrumReady, ui->spectrumWidget, &SpectrumWidget::setSpectrum);
+    connect(ui->scopeWidget, &ScopeWidget::frameReady, ui->measurementPanel, &MeasurementPanel::setSamples);
+    connect(ui->scopeWidget, &ScopeWidget::frameReady, ui->bandWidget, &BandWidget::setSamples);
+    connect(ui->scopeWidget, &ScopeWidget::frameReady, ui->pitchWidget, &PitchWidget::setSamples);
+    connect(ui->scopeWidget, &ScopeWidget::stereoFrameReady, ui->transferWidget, &TransferWidget::setSamples);
+
+    m_publisher = new FramePublisher(this);
+    connect(m_publisher, &FramePublisher::statusChanged, this, [this](const QString &text) {
+        statusBar()->showMessage(text);
+    });
+    connect(ui->scopeWidget, &ScopeWidget::rawFrameReady, m_publisher, &FramePublisher::publishSamples);
+    connect(ui->scopeWidget, &ScopeWidget::spectrumReady, m_publisher, &FramePublisher::publishSpectrum);
+    m_publisher->start();
+
+    m_graphLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(m_graphLabel);
+    connect(ui->scopeWidget, &ScopeWidget::graphTimingsChanged, this,
+        [this](const QString &summary, const QString &details) {
+            m_graphLabel->setText(summary);
+            m_graphLabel->setToolTip(details);
+        });
+    connect(ui->scopeWidget, &ScopeWidget::captureGap, this, [this](qint64 firstFrame, qint64 droppedFrames) {
+        statusBar()->showMessage(QStringLiteral("Capture gap: %1 frames lost before frame %2")
+                                     .arg(droppedFrames)
+                                     .arg(firstFrame),
+            5000);
+    });
+
+    QStringList pluginErrors;
+    const QString pluginDir = QCoreApplication::applicationDirPath() + QStringLiteral("/plugins");
+    const int plugins = ui->scopeWidget->loadPlugins(pluginDir, &pluginErrors);
+    for (const QString &error : pluginErrors) {
+        qWarning().noquote() << error;
+    }
+    if (plugins > 0) {
+        qInfo().noquote() << QStringLiteral("Loaded %1 plugin(s) from %2").arg(plugins).arg(pluginDir);
+    }
+
     ui->spectrumWidget->show();
 
-    if (sources.isEmpty()) {
-        ui->startButton->setEnabled(false);
+    // Devices arrive asynchronously from the scope's watcher thread; capture
+    // is opened from updateDeviceCombos once the first list is in.
+    ui->startButton->setEnabled(false);
+    statusBar()->showMessage(QStringLiteral("Enumerating devices..."));
+}
+
+void MainWindow::setLaunchTimer(const QElapsedTimer &timer)
+{
+    if (timer.isValid()) {
+        m_launchTimer = timer;
+    }
+}
+
+bool MainWindow::event(QEvent *event)
+{
+    if (event->type() == QEvent::Paint && !m_firstPaintSeen) {
+        m_firstPaintSeen = true;
+        QTimer::singleShot(0, this, [this]() {
+            reportStartup(QStringLiteral("First paint"));
+        });
+    }
+    return QMainWindow::event(event);
+}
+
+void MainWindow::updateDeviceCombos()
+{
+    {
+        const QSignalBlocker sourceBlocker(ui->sourceCombo);
+        const QSignalBlocker outputBlocker(ui->outputCombo);
+        ui->sourceCombo->clear();
+        ui->sourceCombo->addItems(ui->scopeWidget->deviceNames());
+        ui->sourceCombo->setCurrentIndex(ui->scopeWidget->deviceIndex());
+        ui->outputCombo->clear();
+        ui->outputCombo->addItems(ui->scopeWidget->outputDeviceNames());
+        ui->outputCombo->setCurrentIndex(ui->scopeWidget->outputDeviceIndex());
+    }
+
+    ui->startButton->setEnabled(ui->sourceCombo->count() > 0);
+    ui->startButton->setText(ui->scopeWidget->isCapturing() ? QStringLiteral("Stop") : QStringLiteral("Start"));
+
+    if (m_devicesSeen) {
+        return;
+    }
+    m_devicesSeen = true;
+    reportStartup(QStringLiteral("Devices enumerated"));
+
+    if (ui->sourceCombo->count() == 0) {
         statusBar()->showMessage(QStringLiteral("No capture devices found"));
-    } else {
-        statusBar()->showMessage(QStringLiteral("Ready"));
-        if (ui->scopeWidget->startCapture()) {
-            ui->startButton->setText(QStringLiteral("Stop"));
-        }
+        return;
+    }
+    if (ui->scopeWidget->startCapture()) {
+        ui->startButton->setText(QStringLiteral("Stop"));
+        reportStartup(QStringLiteral("Capture open"));
     }
 }
+
+void MainWindow::reportStartup(const QString &milestone)
+{
+    const QString text = QStringLiteral("%1 after %2 ms").arg(milestone).arg(m_launchTimer.elapsed());
+    qInfo().noquote() << text;
+    statusBar()->showMessage(text, 5000);
+}
 
 MainWindow::~MainWindow()
 {
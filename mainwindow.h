@@ -1,6 +1,7 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QElapsedTimer>
 #include <QMainWindow>
 
 QT_BEGIN_NAMESPACE
@@ -9,6 +10,9 @@ class MainWindow;
 }
 QT_END_NAMESPACE
 
+class FramePublisher;
+class QLabel;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -17,7 +21,22 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Measures startup from this timer instead of from construction, so the
+    // report covers QApplication setup as well.
+    void setLaunchTimer(const QElapsedTimer &timer);
+
+protected:
+    bool event(QEvent *event) override;
+
 private:
+    void updateDeviceCombos();
+    void reportStartup(const QString &milestone);
+
     Ui::MainWindow *ui;
+    FramePublisher *m_publisher = nullptr;
+    QLabel *m_graphLabel = nullptr;
+    QElapsedTimer m_launchTimer;
+    bool m_firstPaintSeen = false;
+    bool m_devicesSeen = false;
 };
 #endif // MAINWINDOW_H
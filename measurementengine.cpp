@@ -0,0 +1,203 @@
+#include "measurementengine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Half-width of the 4-term Blackman-Harris main lobe, in bins.
+constexpr int kLobeBins = 5;
+constexpr int kMinFftSize = 256;
+constexpr int kMaxFftSize = 65536;
+
+int prevPow2(int value)
+{
+    int n = 1;
+    while ((n << 1) <= value) {
+        n <<= 1;
+    }
+    return n;
+}
+} // namespace
+
+MeasurementEngine::MeasurementEngine()
+{
+    updateWindow();
+}
+
+void MeasurementEngine::setSampleRate(int sampleRate)
+{
+    if (sampleRate <= 0 || sampleRate == m_sampleRate) {
+        return;
+    }
+    m_sampleRate = sampleRate;
+    updateWindow();
+}
+
+void MeasurementEngine::setWindowMs(int ms)
+{
+    ms = std::max(10, ms);
+    if (ms == m_windowMs) {
+        return;
+    }
+    m_windowMs = ms;
+    updateWindow();
+}
+
+void MeasurementEngine::setHarmonics(int count)
+{
+    m_harmonics = std::max(2, count);
+}
+
+void MeasurementEngine::reset()
+{
+    m_count = 0;
+    m_sum = 0.0;
+    m_sumSq = 0.0;
+    m_peak = 0.0;
+    m_result = MeasurementResult();
+}
+
+bool MeasurementEngine::process(const float *samples, int count)
+{
+    bool completed = false;
+    for (int i = 0; i < count; ++i) {
+        const float sample = samples[i];
+        const double value = static_cast<double>(sample);
+        m_sum += value;
+        m_sumSq += value * value;
+        m_peak = std::max(m_peak, std::fabs(value));
+        m_block[m_count] = sample;
+
+        if (++m_count == m_windowFrames) {
+            analyzeWindow();
+            m_count = 0;
+            m_sum = 0.0;
+            m_sumSq = 0.0;
+            m_peak = 0.0;
+            completed = true;
+        }
+    }
+    return completed;
+}
+
+void MeasurementEngine::updateWindow()
+{
+    m_windowFrames = std::max(kMinFftSize, static_cast<int>(static_cast<long long>(m_sampleRate) * m_windowMs / 1000));
+    m_block.assign(m_windowFrames, 0.0f);
+
+    const int n = std::min(kMaxFftSize, prevPow2(m_windowFrames));
+    m_fft.setSize(n);
+    m_fftData.assign(n, std::complex<float>());
+    m_power.assign(n / 2 + 1, 0.0);
+    m_fftWindow.resize(n);
+
+    const double pi = std::acos(-1.0);
+    for (int i = 0; i < n; ++i) {
+        const double phase = 2.0 * pi * static_cast<double>(i) / static_cast<double>(n);
+        m_fftWindow[i] = static_cast<float>(0.35875 - 0.48829 * std::cos(phase)
+            + 0.14128 * std::cos(2.0 * phase) - 0.01168 * std::cos(3.0 * phase));
+    }
+
+    reset();
+}
+
+void MeasurementEngine::analyzeWindow()
+{
+    MeasurementResult result;
+    result.valid = true;
+    result.sampleRate = m_sampleRate;
+    result.windowFrames = m_windowFrames;
+    result.dcOffset = m_sum / m_windowFrames;
+    result.rms = std::sqrt(m_sumSq / m_windowFrames);
+    result.peak = m_peak;
+    result.crestFactor = (result.rms > 0.0) ? (result.peak / result.rms) : 0.0;
+
+    const int n = m_fft.size();
+    const int half = n / 2;
+    result.fftSize = n;
+
+    const float *tail = m_block.data() + (m_windowFrames - n);
+    for (int i = 0; i < n; ++i) {
+        m_fftData[i] = std::complex<float>(tail[i] * m_fftWindow[i], 0.0f);
+    }
+    m_fft.forward(m_fftData.data());
+    for (int i = 0; i <= half; ++i) {
+        m_power[i] = std::norm(std::complex<double>(m_fftData[i]));
+    }
+
+    int peakBin = 0;
+    double peakPower = 0.0;
+    for (int i = kLobeBins + 1; i < half; ++i) {
+        if (m_power[i] > peakPower) {
+            peakPower = m_power[i];
+            peakBin = i;
+        }
+    }
+    if (peakBin == 0) {
+        m_result = result;
+        return;
+    }
+
+    // Gaussian interpolation on the log power is close to exact for the
+    // near-Gaussian Blackman-Harris main lobe.
+    double delta = 0.0;
+    const double a = m_power[peakBin - 1];
+    const double b = m_power[peakBin];
+    const double c = m_power[peakBin + 1];
+    if (a > 0.0 && c > 0.0) {
+        const double la = std::log(a);
+        const double lb = std::log(b);
+        const double lc = std::log(c);
+        const double denom = la - 2.0 * lb + lc;
+        if (denom < 0.0) {
+            delta = std::clamp(0.5 * (la - lc) / denom, -0.5, 0.5);
+        }
+    }
+    const double fundamentalBin = peakBin + delta;
+    result.frequency = fundamentalBin * m_sampleRate / n;
+
+    std::vector<char> used(half + 1, 0);
+    for (int i = 0; i <= kLobeBins; ++i) {
+        used[i] = 1;
+    }
+
+    const double fundamental = bandPower(peakBin, used);
+    double harmonics = 0.0;
+    for (int h = 2; h <= m_harmonics; ++h) {
+        const int center = static_cast<int>(std::lround(h * fundamentalBin));
+        if (center + kLobeBins > half) {
+            break;
+        }
+        harmonics += bandPower(center, used);
+    }
+
+    double noise = 0.0;
+    for (int i = 0; i <= half; ++i) {
+        if (!used[i]) {
+            noise += m_power[i];
+        }
+    }
+
+    if (fundamental > 0.0) {
+        result.thd = std::sqrt(harmonics / fundamental);
+        result.thdN = std::sqrt((harmonics + noise) / fundamental);
+        result.snrDb = (noise > 0.0) ? 10.0 * std::log10(fundamental / noise) : 0.0;
+    }
+
+    m_result = result;
+}
+
+double MeasurementEngine::bandPower(int center, std::vector<char> &used) const
+{
+    const int last = static_cast<int>(used.size()) - 1;
+    const int from = std::max(0, center - kLobeBins);
+    const int to = std::min(last, center + kLobeBins);
+    double power = 0.0;
+    for (int i = from; i <= to; ++i) {
+        if (!used[i]) {
+            power += m_power[i];
+            used[i] = 1;
+        }
+    }
+    return power;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "fft.h"
+
+#include <complex>
+#include <vector>
+
+struct MeasurementResult {
+    bool valid = false;
+    int sampleRate = 0;
+    int windowFrames = 0;
+    int fftSize = 0;
+    double rms = 0.0;
+    double peak = 0.0;
+    double crestFactor = 0.0;
+    double dcOffset = 0.0;
+    double frequency = 0.0;
+    double thd = 0.0;
+    double thdN = 0.0;
+    double snrDb = 0.0;
+};
+
+class MeasurementEngine
+{
+public:
+    MeasurementEngine();
+
+    void setSampleRate(int sampleRate);
+    void setWindowMs(int ms);
+    void setHarmonics(int count);
+    void reset();
+
+    int sampleRate() const { return m_sampleRate; }
+    int windowFrames() const { return m_windowFrames; }
+
+    // Feeds samples into the running window. Returns true when at least one
+    // window completed during this call; the latest one is in result().
+    bool process(const float *samples, int count);
+    const MeasurementResult &result() const { return m_result; }
+
+private:
+    void updateWindow();
+    void analyzeWindow();
+    double bandPower(int center, std::vector<char> &used) const;
+
+    int m_sampleRate = 48000;
+    int m_windowMs = 250;
+    int m_windowFrames = 0;
+    int m_harmonics = 9;
+
+    int m_count = 0;
+    double m_sum = 0.0;
+    double m_sumSq = 0.0;
+    double m_peak = 0.0;
+    std::vector<float> m_block;
+
+    Fft m_fft;
+    std::vector<float> m_fftWindow;
+    std::vector<std::complex<float>> m_fftData;
+    std::vector<double> m_power;
+
+    MeasurementResult m_result;
+};
@@ -0,0 +1,104 @@
+#include "measurementpanel.h"
+
+#include <QGridLayout>
+#include <QLabel>
+#include <QSpinBox>
+
+#include <cmath>
+
+namespace {
+QString formatDb(double value)
+{
+    if (value <= 0.0) {
+        return QStringLiteral("-inf dB");
+    }
+    return QString::number(20.0 * std::log10(value), 'f', 1) + QStringLiteral(" dB");
+}
+
+QString formatPercent(double ratio)
+{
+    return QString::number(ratio * 100.0, 'f', 4) + QStringLiteral(" % (") + formatDb(ratio) + QStringLiteral(")");
+}
+} // namespace
+
+MeasurementPanel::MeasurementPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    qRegisterMetaType<MeasurementResult>("MeasurementResult");
+
+    auto *layout = new QGridLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    layout->addWidget(new QLabel(QStringLiteral("Window"), this), 0, 0);
+    m_windowSpin = new QSpinBox(this);
+    m_windowSpin->setRange(20, 5000);
+    m_windowSpin->setSingleStep(50);
+    m_windowSpin->setValue(250);
+    m_windowSpin->setSuffix(QStringLiteral(" ms"));
+    layout->addWidget(m_windowSpin, 0, 1);
+
+    m_rmsLabel = addReadout(QStringLiteral("RMS"), 1, 0);
+    m_peakLabel = addReadout(QStringLiteral("Peak"), 1, 2);
+    m_crestLabel = addReadout(QStringLiteral("Crest"), 1, 4);
+    m_dcLabel = addReadout(QStringLiteral("DC"), 1, 6);
+    m_frequencyLabel = addReadout(QStringLiteral("Freq"), 2, 0);
+    m_thdLabel = addReadout(QStringLiteral("THD"), 2, 2);
+    m_thdNLabel = addReadout(QStringLiteral("THD+N"), 2, 4);
+    m_snrLabel = addReadout(QStringLiteral("SNR"), 2, 6);
+
+    m_worker = new MeasurementWorker;
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(this, &MeasurementPanel::samplesQueued, m_worker, &MeasurementWorker::processSamples);
+    connect(this, &MeasurementPanel::windowMsChanged, m_worker, &MeasurementWorker::setWindowMs);
+    connect(m_worker, &MeasurementWorker::resultReady, this, &MeasurementPanel::showResult);
+    connect(m_windowSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MeasurementPanel::windowMsChanged);
+    m_thread.start();
+
+    emit windowMsChanged(m_windowSpin->value());
+}
+
+MeasurementPanel::~MeasurementPanel()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void MeasurementPanel::setSamples(const QVector<float> &samples, int sampleRate)
+{
+    emit samplesQueued(samples, sampleRate);
+}
+
+QLabel *MeasurementPanel::addReadout(const QString &name, int row, int column)
+{
+    auto *layout = static_cast<QGridLayout *>(this->layout());
+    layout->addWidget(new QLabel(name, this), row, column);
+    auto *value = new QLabel(QStringLiteral("-"), this);
+    value->setMinimumWidth(120);
+    layout->addWidget(value, row, column + 1);
+    return value;
+}
+
+void MeasurementPanel::showResult(const MeasurementResult &result)
+{
+    if (!result.valid) {
+        return;
+    }
+
+    m_rmsLabel->setText(QString::number(result.rms, 'f', 5) + QStringLiteral(" (") + formatDb(result.rms) + QStringLiteral(")"));
+    m_peakLabel->setText(QString::number(result.peak, 'f', 5) + QStringLiteral(" (") + formatDb(result.peak) + QStringLiteral(")"));
+    m_crestLabel->setText(QString::number(result.crestFactor, 'f', 3) + QStringLiteral(" (") + formatDb(result.crestFactor) + QStringLiteral(")"));
+    m_dcLabel->setText(QString::number(result.dcOffset, 'f', 5));
+
+    if (result.frequency > 0.0) {
+        m_frequencyLabel->setText(QString::number(result.frequency, 'f', 2) + QStringLiteral(" Hz"));
+        m_thdLabel->setText(formatPercent(result.thd));
+        m_thdNLabel->setText(formatPercent(result.thdN));
+        m_snrLabel->setText(QString::number(result.snrDb, 'f', 1) + QStringLiteral(" dB"));
+    } else {
+        m_frequencyLabel->setText(QStringLiteral("-"));
+        m_thdLabel->setText(QStringLiteral("-"));
+        m_thdNLabel->setText(QStringLiteral("-"));
+        m_snrLabel->setText(QStringLiteral("-"));
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QThread>
+#include <QVector>
+#include <QWidget>
+
+#include "measurementworker.h"
+
+class QLabel;
+class QSpinBox;
+
+class MeasurementPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MeasurementPanel(QWidget *parent = nullptr);
+    ~MeasurementPanel() override;
+
+public slots:
+    void setSamples(const QVector<float> &samples, int sampleRate);
+
+signals:
+    void samplesQueued(const QVector<float> &samples, int sampleRate);
+    void windowMsChanged(int ms);
+
+private:
+    void showResult(const MeasurementResult &result);
+    QLabel *addReadout(const QString &name, int row, int column);
+
+    QThread m_thread;
+    MeasurementWorker *m_worker = nullptr;
+
+    QSpinBox *m_windowSpin = nullptr;
+    QLabel *m_rmsLabel = nullptr;
+    QLabel *m_peakLabel = nullptr;
+    QLabel *m_crestLabel = nullptr;
+    QLabel *m_dcLabel = nullptr;
+    QLabel *m_frequencyLabel = nullptr;
+    QLabel *m_thdLabel = nullptr;
+    QLabel *m_thdNLabel = nullptr;
+    QLabel *m_snrLabel = nullptr;
+};
@@ -0,0 +1,23 @@
+#include "measurementworker.h"
+
+MeasurementWorker::MeasurementWorker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void MeasurementWorker::processSamples(const QVector<float> &samples, int sampleRate)
+{
+    if (samples.isEmpty()) {
+        return;
+    }
+
+    m_engine.setSampleRate(sampleRate);
+    if (m_engine.process(samples.constData(), samples.size())) {
+        emit resultReady(m_engine.result());
+    }
+}
+
+void MeasurementWorker::setWindowMs(int ms)
+{
+    m_engine.setWindowMs(ms);
+}
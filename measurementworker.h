@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QMetaType>
+#include <QObject>
+#include <QVector>
+
+#include "measurementengine.h"
+
+class MeasurementWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MeasurementWorker(QObject *parent = nullptr);
+
+public slots:
+    void processSamples(const QVector<float> &samples, int sampleRate);
+    void setWindowMs(int ms);
+
+signals:
+    void resultReady(const MeasurementResult &result);
+
+private:
+    MeasurementEngine m_engine;
+};
+
+Q_DECLARE_METATYPE(MeasurementResult)
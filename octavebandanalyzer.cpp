@@ -0,0 +1,208 @@
+#include "octavebandanalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+namespace {
+const double kPi = std::acos(-1.0);
+
+// Bands stay below this fraction of their stage rate; the decimator cutoff
+// sits just above the next stage's highest band.
+constexpr double kBandLimit = 0.1;
+constexpr double kDecimatorCutoff = 0.13;
+constexpr double kLowestCenter = 12.0;
+
+std::complex<double> bilinearPole(std::complex<double> s, double rate)
+{
+    const std::complex<double> k(2.0 * rate, 0.0);
+    return (k + s) / (k - s);
+}
+} // namespace
+
+void OctaveBandAnalyzer::configure(int sampleRate, int bandsPerOctave)
+{
+    m_sampleRate = sampleRate;
+    m_bandsPerOctave = std::max(1, bandsPerOctave);
+    m_bands.clear();
+    m_stages.clear();
+    if (sampleRate <= 0) {
+        return;
+    }
+
+    const double b = static_cast<double>(m_bandsPerOctave);
+    const double halfBand = std::pow(2.0, 1.0 / (2.0 * b));
+    const double highest = std::min(20000.0, 0.48 * sampleRate / halfBand);
+
+    // Base-2 mid-band frequencies around 1 kHz, per IEC 61260.
+    const int lowIndex = static_cast<int>(std::ceil(b * std::log2(kLowestCenter / 1000.0)));
+    const int highIndex = static_cast<int>(std::floor(b * std::log2(highest / 1000.0)));
+    for (int index = lowIndex; index <= highIndex; ++index) {
+        Band band;
+        band.center = 1000.0 * std::pow(2.0, index / b);
+        const double upper = band.center * halfBand;
+        int stage = 0;
+        while (upper <= kBandLimit * sampleRate / std::pow(2.0, stage + 1)) {
+            ++stage;
+        }
+        band.stage = stage;
+        m_bands.push_back(band);
+    }
+
+    int stageCount = 0;
+    for (const Band &band : m_bands) {
+        stageCount = std::max(stageCount, band.stage + 1);
+    }
+    m_stages.resize(stageCount);
+    for (int s = 0; s < stageCount; ++s) {
+        Stage &stage = m_stages[s];
+        stage.rate = sampleRate / std::pow(2.0, s);
+        stage.fastAlpha = 1.0 - std::exp(-1.0 / (0.125 * stage.rate));
+        stage.slowAlpha = 1.0 - std::exp(-1.0 / (1.0 * stage.rate));
+        designLowPass(stage.decimator, stage.rate, kDecimatorCutoff * stage.rate);
+    }
+    for (int i = 0; i < bandCount(); ++i) {
+        Band &band = m_bands[i];
+        designBandPass(band, m_stages[band.stage].rate, band.center / halfBand, band.center * halfBand);
+        m_stages[band.stage].bands.push_back(i);
+    }
+}
+
+void OctaveBandAnalyzer::process(const float *samples, int count)
+{
+    if (m_stages.empty()) {
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        push(0, static_cast<double>(samples[i]));
+    }
+}
+
+void OctaveBandAnalyzer::resetLeq()
+{
+    for (Band &band : m_bands) {
+        band.sum = 0.0;
+        band.count = 0;
+    }
+}
+
+void OctaveBandAnalyzer::levels(Integration integration, std::vector<float> &out) const
+{
+    out.resize(m_bands.size());
+    for (size_t i = 0; i < m_bands.size(); ++i) {
+        const Band &band = m_bands[i];
+        double meanSquare = 0.0;
+        switch (integration) {
+        case IntegrationFast:
+            meanSquare = band.fast;
+            break;
+        case IntegrationSlow:
+            meanSquare = band.slow;
+            break;
+        case IntegrationLeq:
+        default:
+            meanSquare = (band.count > 0) ? band.sum / static_cast<double>(band.count) : 0.0;
+            break;
+        }
+        out[i] = static_cast<float>(10.0 * std::log10(std::max(2.0 * meanSquare, 1e-20)));
+    }
+}
+
+void OctaveBandAnalyzer::push(int index, double value)
+{
+    Stage &stage = m_stages[index];
+    for (int bandIndex : stage.bands) {
+        Band &band = m_bands[bandIndex];
+        double y = value;
+        for (Section &section : band.sections) {
+            y = section.process(y);
+        }
+        const double power = y * y;
+        band.fast += stage.fastAlpha * (power - band.fast);
+        band.slow += stage.slowAlpha * (power - band.slow);
+        band.sum += power;
+        ++band.count;
+    }
+
+    if (index + 1 >= static_cast<int>(m_stages.size())) {
+        return;
+    }
+
+    double low = value;
+    for (Section &section : stage.decimator) {
+        low = section.process(low);
+    }
+    stage.skip = !stage.skip;
+    if (stage.skip) {
+        push(index + 1, low);
+    }
+}
+
+void OctaveBandAnalyzer::designBandPass(Band &band, double rate, double lower, double upper)
+{
+    // Analog band edges pre-warped for the bilinear transform.
+    const double w1 = 2.0 * rate * std::tan(kPi * lower / rate);
+    const double w2 = 2.0 * rate * std::tan(kPi * upper / rate);
+    const double w0 = std::sqrt(w1 * w2);
+    const double bw = w2 - w1;
+
+    // Third-order Butterworth prototype: one real pole and a conjugate pair.
+    // The band-pass transform maps each prototype pole p to the roots of
+    // s^2 - p*bw*s + w0^2, giving three conjugate pole pairs.
+    const std::complex<double> prototype[2] = {std::polar(1.0, 2.0 * kPi / 3.0), std::complex<double>(-1.0, 0.0)};
+    std::complex<double> poles[3];
+    for (int i = 0; i < 2; ++i) {
+        const std::complex<double> p = prototype[i] * bw;
+        const std::complex<double> root = std::sqrt(p * p - 4.0 * w0 * w0);
+        poles[i] = (p + root) * 0.5;
+        if (i == 0) {
+            poles[2] = (p - root) * 0.5;
+        }
+    }
+
+    const double centerAngle = 2.0 * kPi * std::sqrt(lower * upper) / rate;
+    const std::complex<double> z1 = std::polar(1.0, -centerAngle);
+    for (int i = 0; i < 3; ++i) {
+        Section &section = band.sections[i];
+        const std::complex<double> z = bilinearPole(poles[i], rate);
+        section.a1 = -2.0 * z.real();
+        section.a2 = std::norm(z);
+        if (i == 1 && std::abs(poles[1].imag()) < 1e-12) {
+            // The real prototype pole may map to two real poles when the
+            // band is wide; pair them up instead of with a conjugate.
+            const std::complex<double> p = prototype[1] * bw;
+            const std::complex<double> other = bilinearPole((p - std::sqrt(p * p - 4.0 * w0 * w0)) * 0.5, rate);
+            section.a1 = -(z.real() + other.real());
+            section.a2 = z.real() * other.real();
+        }
+
+        // Zeros at DC and Nyquist; normalise each section to unity at the
+        // band centre.
+        section.b0 = 1.0;
+        section.b1 = 0.0;
+        section.b2 = -1.0;
+        const std::complex<double> num = 1.0 - z1 * z1;
+        const std::complex<double> den = 1.0 + section.a1 * z1 + section.a2 * z1 * z1;
+        const double gain = std::abs(num / den);
+        section.b0 /= gain;
+        section.b2 /= gain;
+    }
+}
+
+void OctaveBandAnalyzer::designLowPass(Section *sections, double rate, double cutoff)
+{
+    // Sixth-order Butterworth as three biquads (RBJ form with the
+    // Butterworth pole Qs).
+    const double qs[3] = {0.5176381, 0.7071068, 1.9318517};
+    const double w0 = 2.0 * kPi * cutoff / rate;
+    const double c = std::cos(w0);
+    for (int i = 0; i < 3; ++i) {
+        const double alpha = std::sin(w0) / (2.0 * qs[i]);
+        const double a0 = 1.0 + alpha;
+        sections[i].b0 = (1.0 - c) / 2.0 / a0;
+        sections[i].b1 = (1.0 - c) / a0;
+        sections[i].b2 = (1.0 - c) / 2.0 / a0;
+        sections[i].a1 = -2.0 * c / a0;
+        sections[i].a2 = (1.0 - alpha) / a0;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+
+// Fractional-octave band levels (1/1, 1/3, 1/12 ...) from a multirate
+// filter bank. Each band is a 6th-order Butterworth band-pass. The signal
+// is halved in rate once per octave through a low-pass decimator, and every
+// band runs at the lowest rate that still leaves it well below Nyquist, so
+// the low-frequency bands cost almost nothing.
+class OctaveBandAnalyzer
+{
+public:
+    enum Integration {
+        IntegrationFast = 0,  // 125 ms exponential
+        IntegrationSlow = 1,  // 1 s exponential
+        IntegrationLeq = 2    // linear average since the last resetLeq()
+    };
+
+    void configure(int sampleRate, int bandsPerOctave);
+    void process(const float *samples, int count);
+    void resetLeq();
+
+    int sampleRate() const { return m_sampleRate; }
+    int bandsPerOctave() const { return m_bandsPerOctave; }
+    int bandCount() const { return static_cast<int>(m_bands.size()); }
+    double centerFrequency(int band) const { return m_bands[band].center; }
+
+    // Levels in dB relative to a full-scale sine, lowest band first.
+    void levels(Integration integration, std::vector<float> &out) const;
+
+private:
+    struct Section {
+        double b0 = 1.0;
+        double b1 = 0.0;
+        double b2 = 0.0;
+        double a1 = 0.0;
+        double a2 = 0.0;
+        double z1 = 0.0;
+        double z2 = 0.0;
+
+        double process(double x)
+        {
+            const double y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
+
+    struct Band {
+        double center = 0.0;
+        int stage = 0;
+        Section sections[3];
+        double fast = 0.0;
+        double slow = 0.0;
+        double sum = 0.0;
+        long long count = 0;
+    };
+
+    struct Stage {
+        double rate = 0.0;
+        double fastAlpha = 0.0;
+        double slowAlpha = 0.0;
+        Section decimator[3];
+        bool skip = false;
+        std::vector<int> bands;
+    };
+
+    static void designBandPass(Band &band, double rate, double lower, double upper);
+    static void designLowPass(Section *sections, double rate, double cutoff);
+    void push(int stage, double value);
+
+    int m_sampleRate = 0;
+    int m_bandsPerOctave = 0;
+    std::vector<Band> m_bands;
+    std::vector<Stage> m_stages;
+};
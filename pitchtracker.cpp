@@ -0,0 +1,145 @@
+#include "pitchtracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+void PitchTracker::configure(int sampleRate, double minFrequency, double maxFrequency, int hop)
+{
+    m_sampleRate = std::max(1, sampleRate);
+    m_hop = std::max(1, hop);
+    m_minLag = std::max(2, static_cast<int>(std::floor(m_sampleRate / std::max(minFrequency, maxFrequency))));
+    m_maxLag = std::max(m_minLag + 2, static_cast<int>(std::ceil(m_sampleRate / std::min(minFrequency, maxFrequency))));
+    m_window = m_maxLag;
+
+    // One frame is the integration window plus the longest lag. A linear
+    // correlation of the first m_window samples against the whole frame
+    // never wraps as long as the FFT covers the frame.
+    const int frame = m_window + m_maxLag + 1;
+    m_history.assign(frame, 0.0f);
+    m_frame.assign(frame, 0.0f);
+    m_fft.setSize(Fft::nextPow2(frame));
+    m_data.assign(m_fft.size(), std::complex<float>());
+    m_difference.assign(m_maxLag + 1, 0.0);
+    reset();
+}
+
+void PitchTracker::reset()
+{
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_write = 0;
+    m_sinceFrame = 0;
+    m_sampleIndex = 0;
+}
+
+int PitchTracker::process(const float *samples, int count, std::vector<PitchEstimate> &out)
+{
+    if (m_history.empty()) {
+        return 0;
+    }
+
+    const int length = static_cast<int>(m_history.size());
+    int added = 0;
+    for (int i = 0; i < count; ++i) {
+        m_history[m_write] = samples[i];
+        m_write = (m_write + 1 == length) ? 0 : m_write + 1;
+        ++m_sampleIndex;
+        if (++m_sinceFrame == m_hop) {
+            m_sinceFrame = 0;
+            out.push_back(analyze());
+            ++added;
+        }
+    }
+    return added;
+}
+
+PitchEstimate PitchTracker::analyze()
+{
+    PitchEstimate estimate;
+    estimate.sampleIndex = m_sampleIndex;
+
+    const int length = static_cast<int>(m_frame.size());
+    for (int i = 0; i < length; ++i) {
+        const int index = m_write + i;
+        m_frame[i] = m_history[index < length ? index : index - length];
+    }
+
+    // z = a + i*b with a = first window (zero padded) and b = whole frame;
+    // r(tau) = sum a[j] b[j + tau] = IFFT(conj(A) * B).
+    const int n = m_fft.size();
+    for (int i = 0; i < n; ++i) {
+        const float a = (i < m_window) ? m_frame[i] : 0.0f;
+        const float b = (i < length) ? m_frame[i] : 0.0f;
+        m_data[i] = std::complex<float>(a, b);
+    }
+    m_fft.forward(m_data.data());
+    for (int k = 0; k <= n / 2; ++k) {
+        const int mirror = (n - k) & (n - 1);
+        const std::complex<float> z = m_data[k];
+        const std::complex<float> zc = std::conj(m_data[mirror]);
+        const std::complex<float> a = 0.5f * (z + zc);
+        const std::complex<float> d = 0.5f * (z - zc);
+        const std::complex<float> b(d.imag(), -d.real());
+        const std::complex<float> product(a.real() * b.real() + a.imag() * b.imag(),
+            a.real() * b.imag() - a.imag() * b.real());
+        m_data[k] = product;
+        m_data[mirror] = std::conj(product);
+    }
+    m_fft.inverse(m_data.data());
+
+    // d(tau) = E(0) + E(tau) - 2 r(tau), with E(tau) the energy of the
+    // window starting at tau, kept as a running sum.
+    double energy0 = 0.0;
+    for (int j = 0; j < m_window; ++j) {
+        energy0 += static_cast<double>(m_frame[j]) * m_frame[j];
+    }
+    if (energy0 <= 1e-12) {
+        return estimate;
+    }
+
+    double energy = energy0;
+    m_difference[0] = 0.0;
+    double runningSum = 0.0;
+    int best = -1;
+    for (int tau = 1; tau <= m_maxLag; ++tau) {
+        const double leaving = m_frame[tau - 1];
+        const double entering = m_frame[tau + m_window - 1];
+        energy += entering * entering - leaving * leaving;
+        const double difference = std::max(0.0, energy0 + energy - 2.0 * m_data[tau].real());
+        runningSum += difference;
+        // Cumulative mean normalised difference.
+        m_difference[tau] = (runningSum > 0.0) ? difference * tau / runningSum : 1.0;
+    }
+
+    // First dip under the threshold, followed down to its minimum.
+    for (int tau = m_minLag; tau < m_maxLag; ++tau) {
+        if (m_difference[tau] < m_threshold) {
+            while (tau + 1 < m_maxLag && m_difference[tau + 1] < m_difference[tau]) {
+                ++tau;
+            }
+            best = tau;
+            break;
+        }
+    }
+    if (best < 0) {
+        best = m_minLag;
+        for (int tau = m_minLag + 1; tau < m_maxLag; ++tau) {
+            if (m_difference[tau] < m_difference[best]) {
+                best = tau;
+            }
+        }
+        estimate.confidence = std::max(0.0, 1.0 - m_difference[best]);
+        estimate.frequency = static_cast<double>(m_sampleRate) / best;
+        return estimate;
+    }
+
+    const double a = m_difference[best - 1];
+    const double b = m_difference[best];
+    const double c = m_difference[best + 1];
+    const double denominator = a - 2.0 * b + c;
+    const double shift = (denominator > 0.0) ? 0.5 * (a - c) / denominator : 0.0;
+
+    estimate.voiced = true;
+    estimate.frequency = static_cast<double>(m_sampleRate) / (best + shift);
+    estimate.confidence = std::max(0.0, 1.0 - b);
+    return estimate;
+}
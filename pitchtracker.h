@@ -0,0 +1,52 @@
+#pragma once
+
+#include "fft.h"
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+struct PitchEstimate {
+    int64_t sampleIndex = 0;   // newest sample of the analysed frame
+    bool voiced = false;
+    double frequency = 0.0;
+    double confidence = 0.0;   // 1 - YIN aperiodicity at the chosen lag
+};
+
+// YIN fundamental-frequency tracker. The difference function comes from
+// an FFT cross-correlation (both operands packed into one complex
+// transform) plus running energy sums, so a frame costs O(n log n)
+// instead of O(n * lags).
+class PitchTracker
+{
+public:
+    void configure(int sampleRate, double minFrequency = 40.0, double maxFrequency = 2000.0, int hop = 512);
+    void setThreshold(double threshold) { m_threshold = threshold; }
+    void reset();
+
+    int sampleRate() const { return m_sampleRate; }
+    int hop() const { return m_hop; }
+
+    // Appends one estimate per completed hop; returns how many were added.
+    int process(const float *samples, int count, std::vector<PitchEstimate> &out);
+
+private:
+    PitchEstimate analyze();
+
+    int m_sampleRate = 0;
+    int m_hop = 512;
+    int m_minLag = 0;
+    int m_maxLag = 0;
+    int m_window = 0;
+    double m_threshold = 0.15;
+
+    int m_write = 0;
+    int m_sinceFrame = 0;
+    int64_t m_sampleIndex = 0;
+    std::vector<float> m_history;
+
+    Fft m_fft;
+    std::vector<float> m_frame;
+    std::vector<std::complex<float>> m_data;
+    std::vector<double> m_difference;
+};
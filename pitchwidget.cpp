@@ -0,0 +1,176 @@
+#include "pitchwidget.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kLowestNote = 32.70319566;  // C1
+constexpr double kTraceLow = 40.0;
+constexpr double kTraceHigh = 2000.0;
+constexpr double kHistorySeconds = 10.0;
+constexpr float kFloorDb = -100.0f;
+constexpr int kCqtFramesPerSecond = 50;
+constexpr double kMinConfidence = 0.8;
+
+QString noteName(double hz, int *cents = nullptr)
+{
+    static const char *const names[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+    const double midi = 69.0 + 12.0 * std::log2(hz / 440.0);
+    const int nearest = static_cast<int>(std::lround(midi));
+    if (cents) {
+        *cents = static_cast<int>(std::lround((midi - nearest) * 100.0));
+    }
+    const int octave = nearest / 12 - 1;
+    return QString::fromLatin1(names[((nearest % 12) + 12) % 12]) + QString::number(octave);
+}
+} // namespace
+
+PitchWidget::PitchWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(180);
+    setAutoFillBackground(false);
+}
+
+void PitchWidget::setBinsPerOctave(int bins)
+{
+    m_binsPerOctave = std::max(1, bins);
+    if (m_tracker.sampleRate() > 0) {
+        configure(m_tracker.sampleRate());
+    }
+    update();
+}
+
+void PitchWidget::configure(int sampleRate)
+{
+    m_cqt.configure(sampleRate, kLowestNote, m_binsPerOctave, std::max(1, sampleRate / kCqtFramesPerSecond));
+    m_levels.assign(m_cqt.binCount(), kFloorDb);
+    if (m_tracker.sampleRate() != sampleRate) {
+        m_tracker.configure(sampleRate, kTraceLow, kTraceHigh);
+        m_historyLength = static_cast<int>(kHistorySeconds * sampleRate / m_tracker.hop());
+        m_history.clear();
+    }
+}
+
+void PitchWidget::setSamples(const QVector<float> &samples, int sampleRate)
+{
+    if (sampleRate <= 0) {
+        return;
+    }
+    if (sampleRate != m_tracker.sampleRate()) {
+        configure(sampleRate);
+    }
+
+    if (m_cqt.process(samples.constData(), samples.size())) {
+        const std::vector<float> &magnitudes = m_cqt.magnitudes();
+        for (size_t i = 0; i < magnitudes.size(); ++i) {
+            m_levels[i] = (magnitudes[i] > 0.0f) ? std::max(kFloorDb, 20.0f * std::log10(magnitudes[i])) : kFloorDb;
+        }
+    }
+
+    m_estimates.clear();
+    m_tracker.process(samples.constData(), samples.size(), m_estimates);
+    for (const PitchEstimate &estimate : m_estimates) {
+        m_history.push_back(estimate);
+    }
+    while (static_cast<int>(m_history.size()) > m_historyLength) {
+        m_history.pop_front();
+    }
+    update();
+}
+
+void PitchWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(10, 10, 14));
+
+    if (m_levels.empty()) {
+        painter.setPen(QColor(120, 120, 140));
+        painter.drawText(rect(), Qt::AlignCenter, QStringLiteral("No signal"));
+        return;
+    }
+
+    painter.setFont(QFont(painter.font().family(), 8));
+    const double split = height() * 0.45;
+    paintSpectrum(painter, QRectF(0.0, 0.0, width(), split));
+    paintTrace(painter, QRectF(0.0, split, width(), height() - split));
+}
+
+void PitchWidget::paintSpectrum(QPainter &painter, const QRectF &area)
+{
+    const int count = static_cast<int>(m_levels.size());
+    const double slot = area.width() / count;
+    const double labelHeight = 14.0;
+    const double plotHeight = area.height() - labelHeight;
+
+    for (int i = 0; i < count; ++i) {
+        const double top = area.top() + (m_levels[i] / kFloorDb) * plotHeight;
+        painter.fillRect(QRectF(i * slot, top, std::max(1.0, slot), area.top() + plotHeight - top), QColor(0, 140, 220));
+    }
+
+    // Label every C.
+    painter.setPen(QPen(QColor(150, 150, 170), 1.0));
+    for (double c = kLowestNote; c < m_cqt.frequency(count - 1); c *= 2.0) {
+        const double bin = m_binsPerOctave * std::log2(c / m_cqt.frequency(0));
+        if (bin < -0.5) {
+            continue;
+        }
+        const double x = (bin + 0.5) * slot;
+        painter.drawLine(QPointF(x, area.top() + plotHeight), QPointF(x, area.top() + plotHeight + 3.0));
+        painter.drawText(QPointF(x + 2.0, area.bottom() - 2.0), noteName(c));
+    }
+}
+
+void PitchWidget::paintTrace(QPainter &painter, const QRectF &area)
+{
+    const double span = std::log2(kTraceHigh / kTraceLow);
+    auto yFor = [&](double hz) {
+        return area.bottom() - std::log2(hz / kTraceLow) / span * area.height();
+    };
+
+    painter.setPen(QPen(QColor(40, 40, 60)));
+    for (double c = kLowestNote * 2.0; c < kTraceHigh; c *= 2.0) {
+        const double y = yFor(c);
+        painter.drawLine(QPointF(area.left(), y), QPointF(area.right(), y));
+        painter.drawText(QPointF(area.left() + 2.0, y - 2.0), noteName(c));
+    }
+
+    if (m_historyLength <= 0) {
+        return;
+    }
+
+    // Newest estimate at the right edge.
+    const double step = area.width() / m_historyLength;
+    const int offset = m_historyLength - static_cast<int>(m_history.size());
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(220, 160, 0));
+    for (size_t i = 0; i < m_history.size(); ++i) {
+        const PitchEstimate &estimate = m_history[i];
+        if (!estimate.voiced || estimate.confidence < kMinConfidence) {
+            continue;
+        }
+        const double x = area.left() + (offset + static_cast<double>(i)) * step;
+        painter.drawEllipse(QPointF(x, yFor(estimate.frequency)), 1.5, 1.5);
+    }
+    painter.setBrush(Qt::NoBrush);
+
+    if (!m_history.empty()) {
+        const PitchEstimate &latest = m_history.back();
+        QString text = QStringLiteral("-");
+        if (latest.voiced && latest.confidence >= kMinConfidence) {
+            int cents = 0;
+            const QString note = noteName(latest.frequency, &cents);
+            text = QStringLiteral("%1 %2%3 cents  %4 Hz")
+                       .arg(note)
+                       .arg(cents >= 0 ? QStringLiteral("+") : QString())
+                       .arg(cents)
+                       .arg(latest.frequency, 0, 'f', 1);
+        }
+        painter.setPen(QPen(QColor(220, 220, 230), 1.0));
+        painter.drawText(area.adjusted(0.0, 2.0, -4.0, 0.0), Qt::AlignRight | Qt::AlignTop, text);
+    }
+}
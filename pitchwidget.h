@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QVector>
+#include <QWidget>
+
+#include <deque>
+#include <vector>
+
+#include "constantqtransform.h"
+#include "pitchtracker.h"
+
+// Constant-Q spectrum with note labels on top and a scrolling pitch trace
+// below, both fed from the mono capture stream.
+class PitchWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PitchWidget(QWidget *parent = nullptr);
+
+    void setBinsPerOctave(int bins);
+
+public slots:
+    void setSamples(const QVector<float> &samples, int sampleRate);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void configure(int sampleRate);
+    void paintSpectrum(QPainter &painter, const QRectF &area);
+    void paintTrace(QPainter &painter, const QRectF &area);
+
+    ConstantQTransform m_cqt;
+    PitchTracker m_tracker;
+    int m_binsPerOctave = 24;
+    std::vector<float> m_levels;
+    std::vector<PitchEstimate> m_estimates;
+    std::deque<PitchEstimate> m_history;
+    int m_historyLength = 0;
+};
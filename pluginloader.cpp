@@ -0,0 +1,120 @@
+#include "pluginloader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+bool isLibrary(const fs::path &path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+#if defined(_WIN32)
+    return extension == ".dll";
+#elif defined(__APPLE__)
+    return extension == ".dylib" || extension == ".so" || extension == ".bundle";
+#else
+    return extension == ".so";
+#endif
+}
+
+#ifdef _WIN32
+using LibraryHandle = HMODULE;
+
+LibraryHandle openLibrary(const std::string &path, std::string *error)
+{
+    const HMODULE library = LoadLibraryW(fs::u8path(path).wstring().c_str());
+    if (!library && error) {
+        *error = path + ": cannot load library (error " + std::to_string(GetLastError()) + ")";
+    }
+    return library;
+}
+
+ScopeVibePluginEntry findEntry(LibraryHandle library)
+{
+    return reinterpret_cast<ScopeVibePluginEntry>(GetProcAddress(library, SCOPEVIBE_PLUGIN_ENTRY));
+}
+
+void closeLibrary(LibraryHandle library)
+{
+    FreeLibrary(library);
+}
+#else
+using LibraryHandle = void *;
+
+LibraryHandle openLibrary(const std::string &path, std::string *error)
+{
+    void *library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!library && error) {
+        const char *message = dlerror();
+        *error = message ? std::string(message) : path + ": cannot load library";
+    }
+    return library;
+}
+
+ScopeVibePluginEntry findEntry(LibraryHandle library)
+{
+    return reinterpret_cast<ScopeVibePluginEntry>(dlsym(library, SCOPEVIBE_PLUGIN_ENTRY));
+}
+
+void closeLibrary(LibraryHandle library)
+{
+    dlclose(library);
+}
+#endif
+} // namespace
+
+std::unique_ptr<BlockProcessor> loadPlugin(const std::string &path, std::string *error)
+{
+    const LibraryHandle library = openLibrary(path, error);
+    if (!library) {
+        return nullptr;
+    }
+
+    const ScopeVibePluginEntry entry = findEntry(library);
+    const ScopeVibePluginDescriptor *descriptor = entry ? entry() : nullptr;
+    if (!descriptor || descriptor->apiVersion != SCOPEVIBE_PLUGIN_API_VERSION || !descriptor->create
+        || !descriptor->destroy || !descriptor->process) {
+        if (error) {
+            *error = fs::u8path(path).filename().u8string() + ": not a compatible plugin";
+        }
+        closeLibrary(library);
+        return nullptr;
+    }
+    return std::make_unique<PluginProcessor>(descriptor);
+}
+
+std::vector<std::unique_ptr<BlockProcessor>> loadPlugins(const std::string &directory, std::vector<std::string> *errors)
+{
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (fs::directory_iterator it(fs::u8path(directory), ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && isLibrary(it->path())) {
+            files.push_back(it->path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<std::unique_ptr<BlockProcessor>> plugins;
+    for (const fs::path &file : files) {
+        std::string error;
+        std::unique_ptr<BlockProcessor> plugin = loadPlugin(file.u8string(), &error);
+        if (plugin) {
+            plugins.push_back(std::move(plugin));
+        } else if (errors) {
+            errors->push_back(error);
+        }
+    }
+    return plugins;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "processinggraph.h"
+
+// Loads one block-processor plugin library. The library stays loaded for
+// the lifetime of the process; returns null and sets `error` if the file
+// cannot be loaded or is not a compatible plugin.
+std::unique_ptr<BlockProcessor> loadPlugin(const std::string &path, std::string *error = nullptr);
+
+// Loads every plugin library found in `directory`, in file name order.
+// Files that are not compatible plugins are skipped and reported in
+// `errors`.
+std::vector<std::unique_ptr<BlockProcessor>> loadPlugins(const std::string &directory,
+    std::vector<std::string> *errors = nullptr);
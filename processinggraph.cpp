@@ -0,0 +1,347 @@
+#include "processinggraph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+void record(NodeTiming &timing, Clock::time_point start)
+{
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    ++timing.calls;
+    timing.totalMs += ms;
+    timing.maxMs = std::max(timing.maxMs, ms);
+}
+
+void clearTiming(NodeTiming &timing)
+{
+    timing.calls = 0;
+    timing.totalMs = 0.0;
+    timing.maxMs = 0.0;
+}
+} // namespace
+
+void BlockSink::prepare(int sampleRate, int channels, int maxFrames)
+{
+    (void)sampleRate;
+    (void)channels;
+    (void)maxFrames;
+}
+
+CallbackSink::CallbackSink(const std::string &name, Callback callback, bool wantsSpectrum)
+    : m_name(name)
+    , m_callback(std::move(callback))
+    , m_wantsSpectrum(wantsSpectrum)
+{
+}
+
+FilterChainProcessor::FilterChainProcessor(FilterChain &chain)
+    : m_chain(chain)
+{
+}
+
+bool FilterChainProcessor::prepare(int sampleRate, int channels, int maxFrames)
+{
+    (void)sampleRate;
+    (void)maxFrames;
+    m_channels = channels;
+    return true;
+}
+
+void FilterChainProcessor::process(float *interleaved, int frames)
+{
+    m_chain.process(interleaved, frames, m_channels);
+}
+
+PluginProcessor::PluginProcessor(const ScopeVibePluginDescriptor *descriptor)
+    : m_descriptor(descriptor)
+{
+}
+
+PluginProcessor::~PluginProcessor()
+{
+    if (m_instance) {
+        m_descriptor->destroy(m_instance);
+    }
+}
+
+std::string PluginProcessor::name() const
+{
+    return (m_descriptor && m_descriptor->name) ? std::string(m_descriptor->name) : std::string("plugin");
+}
+
+bool PluginProcessor::prepare(int sampleRate, int channels, int maxFrames)
+{
+    if (m_instance) {
+        m_descriptor->destroy(m_instance);
+        m_instance = nullptr;
+    }
+    m_instance = m_descriptor->create(sampleRate, channels, maxFrames);
+    return m_instance != nullptr;
+}
+
+void PluginProcessor::process(float *interleaved, int frames)
+{
+    m_descriptor->process(m_instance, interleaved, frames);
+}
+
+void PluginProcessor::reset()
+{
+    if (m_instance && m_descriptor->reset) {
+        m_descriptor->reset(m_instance);
+    }
+}
+
+ProcessingGraph::ProcessingGraph()
+{
+    m_mixTiming.name = "mix";
+    m_stftTiming.name = "stft";
+    setStftSize(kDefaultStftSize);
+}
+
+void ProcessingGraph::configure(int sampleRate, int channels, int maxFrames)
+{
+    m_sampleRate = sampleRate;
+    m_channels = std::max(1, channels);
+    m_maxFrames = std::max(1, maxFrames);
+    m_mono.assign(m_maxFrames, 0.0f);
+
+    for (ProcessorNode &node : m_processors) {
+        node.ready = node.processor->prepare(m_sampleRate, m_channels, m_maxFrames);
+    }
+    for (SinkNode &node : m_sinks) {
+        node.sink->prepare(m_sampleRate, m_channels, m_maxFrames);
+    }
+    reset();
+}
+
+void ProcessingGraph::setStftSize(int size)
+{
+    const int n = Fft::nextPow2(std::max(8, size));
+    m_fft.setSize(n);
+    m_stftInput.assign(n, 0.0f);
+    m_stftData.assign(n, std::complex<float>());
+    m_spectrum.assign(n / 2, 0.0f);
+    m_stftFill = 0;
+
+    const float pi = std::acos(-1.0f);
+    m_stftWindow.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_stftWindow[i] = 0.5f * (1.0f - std::cos(2.0f * pi * i / (n - 1)));
+    }
+}
+
+bool ProcessingGraph::addProcessor(std::unique_ptr<BlockProcessor> processor)
+{
+    ProcessorNode node;
+    node.timing.name = processor->name();
+    if (isConfigured()) {
+        node.ready = processor->prepare(m_sampleRate, m_channels, m_maxFrames);
+    }
+    node.processor = std::move(processor);
+    m_processors.push_back(std::move(node));
+    return !isConfigured() || m_processors.back().ready;
+}
+
+void ProcessingGraph::addSink(std::unique_ptr<BlockSink> sink)
+{
+    SinkNode node;
+    node.timing.name = sink->name();
+    if (isConfigured()) {
+        sink->prepare(m_sampleRate, m_channels, m_maxFrames);
+    }
+    node.sink = std::move(sink);
+    m_sinks.push_back(std::move(node));
+}
+
+void ProcessingGraph::setPosition(long long firstFrame, long long timestampNs, bool discontinuity)
+{
+    m_frameIndex = firstFrame;
+    m_timestampNs = timestampNs;
+    if (discontinuity) {
+        m_discontinuity = true;
+        m_stftFill = 0;
+    }
+}
+
+void ProcessingGraph::process(float *interleaved, int frames)
+{
+    if (!isConfigured()) {
+        return;
+    }
+    while (frames > 0) {
+        const int block = std::min(frames, m_maxFrames);
+        processBlock(interleaved, block);
+        interleaved += static_cast<size_t>(block) * m_channels;
+        frames -= block;
+    }
+}
+
+void ProcessingGraph::reset()
+{
+    for (ProcessorNode &node : m_processors) {
+        if (node.ready) {
+            node.processor->reset();
+        }
+    }
+    m_frameIndex = 0;
+    m_timestampNs = 0;
+    m_discontinuity = false;
+    m_stftFill = 0;
+}
+
+int ProcessingGraph::latencyFrames() const
+{
+    int frames = 0;
+    for (const ProcessorNode &node : m_processors) {
+        if (node.ready) {
+            frames += node.processor->latencyFrames();
+        }
+    }
+    return frames;
+}
+
+std::vector<NodeTiming> ProcessingGraph::timings() const
+{
+    std::vector<NodeTiming> result;
+    result.reserve(m_processors.size() + m_sinks.size() + 2);
+    for (const ProcessorNode &node : m_processors) {
+        result.push_back(node.timing);
+    }
+    result.push_back(m_mixTiming);
+    result.push_back(m_stftTiming);
+    for (const SinkNode &node : m_sinks) {
+        result.push_back(node.timing);
+    }
+    return result;
+}
+
+void ProcessingGraph::resetTimings()
+{
+    for (ProcessorNode &node : m_processors) {
+        clearTiming(node.timing);
+    }
+    for (SinkNode &node : m_sinks) {
+        clearTiming(node.timing);
+    }
+    clearTiming(m_mixTiming);
+    clearTiming(m_stftTiming);
+}
+
+void ProcessingGraph::processBlock(float *interleaved, int frames)
+{
+    for (ProcessorNode &node : m_processors) {
+        if (!node.ready) {
+            continue;
+        }
+        const Clock::time_point start = Clock::now();
+        node.processor->process(interleaved, frames);
+        record(node.timing, start);
+    }
+
+    Clock::time_point start = Clock::now();
+    mixDown(interleaved, frames);
+    record(m_mixTiming, start);
+
+    bool wantsSpectrum = false;
+    for (const SinkNode &node : m_sinks) {
+        wantsSpectrum = wantsSpectrum || node.sink->wantsSpectrum();
+    }
+    bool spectrumReady = false;
+    if (wantsSpectrum) {
+        start = Clock::now();
+        spectrumReady = runStft(frames);
+        record(m_stftTiming, start);
+    }
+
+    GraphBlock block;
+    block.interleaved = interleaved;
+    block.mono = m_mono.data();
+    block.frames = frames;
+    block.channels = m_channels;
+    block.sampleRate = m_sampleRate;
+    // The processors hand back samples that entered latency frames ago.
+    const int latency = latencyFrames();
+    block.firstFrame = m_frameIndex - latency;
+    block.timestampNs = m_timestampNs;
+    if (m_timestampNs != 0) {
+        block.timestampNs -= static_cast<long long>(latency) * 1000000000LL / m_sampleRate;
+    }
+    block.discontinuity = m_discontinuity;
+    if (spectrumReady) {
+        block.spectrum = m_spectrum.data();
+        block.spectrumBins = static_cast<int>(m_spectrum.size());
+    }
+
+    for (SinkNode &node : m_sinks) {
+        start = Clock::now();
+        node.sink->consume(block);
+        record(node.timing, start);
+    }
+
+    m_frameIndex += frames;
+    if (m_timestampNs != 0) {
+        m_timestampNs += static_cast<long long>(frames) * 1000000000LL / m_sampleRate;
+    }
+    m_discontinuity = false;
+}
+
+void ProcessingGraph::mixMono(const float *interleaved, int frames, int channels, MonoMix mix, float *mono)
+{
+    const int right = (channels > 1) ? 1 : 0;
+    for (int i = 0; i < frames; ++i) {
+        const float *frame = interleaved + static_cast<size_t>(i) * channels;
+        switch (mix) {
+        case MixLeft:
+            mono[i] = frame[0];
+            break;
+        case MixRight:
+            mono[i] = frame[right];
+            break;
+        case MixAverage:
+        default:
+            mono[i] = (frame[0] + frame[right]) * 0.5f;
+            break;
+        }
+    }
+}
+
+void ProcessingGraph::mixDown(const float *interleaved, int frames)
+{
+    mixMono(interleaved, frames, m_channels, m_mix, m_mono.data());
+}
+
+bool ProcessingGraph::runStft(int frames)
+{
+    const int n = m_fft.size();
+    const int hop = n / 2;
+    bool produced = false;
+
+    int offset = 0;
+    while (offset < frames) {
+        const int take = std::min(frames - offset, n - m_stftFill);
+        std::memcpy(m_stftInput.data() + m_stftFill, m_mono.data() + offset, sizeof(float) * take);
+        m_stftFill += take;
+        offset += take;
+        if (m_stftFill < n) {
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            m_stftData[i] = std::complex<float>(m_stftInput[i] * m_stftWindow[i], 0.0f);
+        }
+        m_fft.forward(m_stftData.data());
+        const float scale = 1.0f / static_cast<float>(n);
+        for (int i = 0; i < hop; ++i) {
+            m_spectrum[i] = std::abs(m_stftData[i]) * scale;
+        }
+
+        std::memmove(m_stftInput.data(), m_stftInput.data() + hop, sizeof(float) * (n - hop));
+        m_stftFill = n - hop;
+        produced = true;
+    }
+    return produced;
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "fft.h"
+#include "filterchain.h"
+#include "scopevibeplugin.h"
+
+#include <complex>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One processed block as the analysis branches see it. Every pointer is
+// owned by the graph and valid only for the duration of consume().
+struct GraphBlock {
+    const float *interleaved = nullptr;
+    const float *mono = nullptr;
+    int frames = 0;
+    int channels = 0;
+    int sampleRate = 0;
+    long long firstFrame = 0;
+    // Monotonic capture time of the first frame (0 when unknown), and
+    // whether frames were lost right before this block.
+    long long timestampNs = 0;
+    bool discontinuity = false;
+    // Latest STFT magnitude frame when one completed during this block,
+    // otherwise null.
+    const float *spectrum = nullptr;
+    int spectrumBins = 0;
+};
+
+// In-place stage ahead of the branches (filters, plugins). prepare() runs
+// outside the stream and allocates everything; process() never sees more
+// than maxFrames frames and must not allocate.
+class BlockProcessor
+{
+public:
+    virtual ~BlockProcessor() = default;
+
+    virtual std::string name() const = 0;
+    virtual bool prepare(int sampleRate, int channels, int maxFrames) = 0;
+    virtual void process(float *interleaved, int frames) = 0;
+    virtual void reset() {}
+    // Frames by which the output trails the input.
+    virtual int latencyFrames() const { return 0; }
+};
+
+// Analysis branch at the end of the graph. All branches see the same
+// processed block; the mono mix and the STFT are computed once for all.
+class BlockSink
+{
+public:
+    virtual ~BlockSink() = default;
+
+    virtual std::string name() const = 0;
+    virtual void prepare(int sampleRate, int channels, int maxFrames);
+    virtual bool wantsSpectrum() const { return false; }
+    virtual void consume(const GraphBlock &block) = 0;
+};
+
+class CallbackSink : public BlockSink
+{
+public:
+    using Callback = std::function<void(const GraphBlock &)>;
+
+    CallbackSink(const std::string &name, Callback callback, bool wantsSpectrum = false);
+
+    std::string name() const override { return m_name; }
+    bool wantsSpectrum() const override { return m_wantsSpectrum; }
+    void consume(const GraphBlock &block) override { m_callback(block); }
+
+private:
+    std::string m_name;
+    Callback m_callback;
+    bool m_wantsSpectrum = false;
+};
+
+// Runs a filter chain owned elsewhere, so presets can change while the
+// graph keeps running.
+class FilterChainProcessor : public BlockProcessor
+{
+public:
+    explicit FilterChainProcessor(FilterChain &chain);
+
+    std::string name() const override { return "filters"; }
+    bool prepare(int sampleRate, int channels, int maxFrames) override;
+    void process(float *interleaved, int frames) override;
+    int latencyFrames() const override { return m_chain.latencyFrames(); }
+
+private:
+    FilterChain &m_chain;
+    int m_channels = 1;
+};
+
+// Adapts a plugin descriptor; a new instance is created on every prepare().
+class PluginProcessor : public BlockProcessor
+{
+public:
+    explicit PluginProcessor(const ScopeVibePluginDescriptor *descriptor);
+    ~PluginProcessor() override;
+
+    std::string name() const override;
+    bool prepare(int sampleRate, int channels, int maxFrames) override;
+    void process(float *interleaved, int frames) override;
+    void reset() override;
+
+private:
+    const ScopeVibePluginDescriptor *m_descriptor = nullptr;
+    void *m_instance = nullptr;
+};
+
+struct NodeTiming {
+    std::string name;
+    long long calls = 0;
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+
+    double averageMs() const { return (calls > 0) ? totalMs / static_cast<double>(calls) : 0.0; }
+};
+
+// Captured stream -> processors in series -> mono mix / STFT -> branches.
+// Input of any length is cut into blocks of at most maxFrames, and every
+// node is timed so a slow one can be singled out.
+//
+// The shared STFT is a Hann-windowed mono magnitude spectrum for display.
+// Analyses that need something else keep their own transform: distortion
+// measurements a long Blackman-Harris power spectrum, pitch a YIN
+// correlation, the constant-Q view complex frames for its kernels, and the
+// transfer function per-channel cross-spectra. Band levels use filters.
+class ProcessingGraph
+{
+public:
+    enum MonoMix {
+        MixLeft = 0,
+        MixRight = 1,
+        MixAverage = 2
+    };
+
+    static constexpr int kDefaultMaxFrames = 4096;
+    static constexpr int kDefaultStftSize = 2048;
+
+    ProcessingGraph();
+
+    // (Re)prepares every node. Processors that fail to prepare are
+    // bypassed until the next successful configure().
+    void configure(int sampleRate, int channels, int maxFrames = kDefaultMaxFrames);
+    bool isConfigured() const { return m_channels > 0; }
+    int sampleRate() const { return m_sampleRate; }
+    int channels() const { return m_channels; }
+    int maxFrames() const { return m_maxFrames; }
+
+    void setMonoMix(MonoMix mix) { m_mix = mix; }
+    MonoMix monoMix() const { return m_mix; }
+    // The mono mix the branches see, for `frames` frames of `channels`.
+    static void mixMono(const float *interleaved, int frames, int channels, MonoMix mix, float *mono);
+    void setStftSize(int size);
+
+    bool addProcessor(std::unique_ptr<BlockProcessor> processor);
+    void addSink(std::unique_ptr<BlockSink> sink);
+
+    // Places the next process() call on the capture timeline. Without it
+    // blocks are numbered back to back. A discontinuity restarts the STFT
+    // so no frame spans the gap. Branches see positions moved back by
+    // latencyFrames(), so they describe the processed samples.
+    void setPosition(long long firstFrame, long long timestampNs, bool discontinuity);
+    void process(float *interleaved, int frames);
+    void reset();
+    // Total delay of the processors that are running.
+    int latencyFrames() const;
+
+    // Processors first, then the shared stages, then the branches.
+    std::vector<NodeTiming> timings() const;
+    void resetTimings();
+
+private:
+    struct ProcessorNode {
+        std::unique_ptr<BlockProcessor> processor;
+        bool ready = false;
+        NodeTiming timing;
+    };
+
+    struct SinkNode {
+        std::unique_ptr<BlockSink> sink;
+        NodeTiming timing;
+    };
+
+    void processBlock(float *interleaved, int frames);
+    void mixDown(const float *interleaved, int frames);
+    bool runStft(int frames);
+
+    int m_sampleRate = 0;
+    int m_channels = 0;
+    int m_maxFrames = kDefaultMaxFrames;
+    MonoMix m_mix = MixAverage;
+    long long m_frameIndex = 0;
+    long long m_timestampNs = 0;
+    bool m_discontinuity = false;
+
+    std::vector<ProcessorNode> m_processors;
+    std::vector<SinkNode> m_sinks;
+
+    std::vector<float> m_mono;
+    NodeTiming m_mixTiming;
+
+    Fft m_fft;
+    std::vector<float> m_stftWindow;
+    std::vector<float> m_stftInput;
+    std::vector<std::complex<float>> m_stftData;
+    std::vector<float> m_spectrum;
+    int m_stftFill = 0;
+    NodeTiming m_stftTiming;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+ * Plain C interface for external block processors. A plugin is a shared
+ * library that exports scopevibe_plugin_descriptor(); the host looks the
+ * symbol up at runtime, so plugins do not need to match the host's
+ * compiler or C++ runtime.
+ *
+ * create() runs outside the audio path and must allocate everything the
+ * instance needs for blocks of up to maxFrames frames. process() runs on
+ * the capture path: it must not allocate, lock or block.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCOPEVIBE_PLUGIN_API_VERSION 1
+#define SCOPEVIBE_PLUGIN_ENTRY "scopevibe_plugin_descriptor"
+
+#if defined(_WIN32)
+#define SCOPEVIBE_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define SCOPEVIBE_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+typedef struct ScopeVibePluginDescriptor {
+    int apiVersion;
+    const char *name;
+    /* Returns a new instance, or null if the format is not supported. */
+    void *(*create)(int sampleRate, int channels, int maxFrames);
+    void (*destroy)(void *instance);
+    void (*reset)(void *instance);
+    /* Processes interleaved frames in place; frames never exceeds maxFrames. */
+    void (*process)(void *instance, float *interleaved, int frames);
+} ScopeVibePluginDescriptor;
+
+typedef const ScopeVibePluginDescriptor *(*ScopeVibePluginEntry)(void);
+
+#ifdef __cplusplus
+}
+#endif
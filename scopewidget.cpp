@@ -3,83 +3,111 @@
 #include <QPainter>
 #include <QStringList>
 
+#include "pluginloader.h"
+
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 
 namespace {
-QVector<float> toSamples(const void *data, DWORD bytes, const WAVEFORMATEX &format, ScopeWidget::ChannelMode mode)
+// Playback is written this far ahead of the play cursor.
+constexpr int kPlayLeadMs = 40;
+
+int64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void appendInterleaved(QVector<float> &out, const void *data, DWORD bytes, const WAVEFORMATEX &format)
 {
-    QVector<float> samples;
     if (format.wBitsPerSample != 16 || format.nChannels < 1) {
-        return samples;
+        return;
     }
 
     const int16_t *pcm = reinterpret_cast<const int16_t *>(data);
-    const int frames = static_cast<int>(bytes / format.nBlockAlign);
-    samples.reserve(frames);
-
-    for (int i = 0; i < frames; ++i) {
-        int16_t left = pcm[i * format.nChannels];
-        int16_t right = left;
-        if (format.nChannels > 1) {
-            right = pcm[i * format.nChannels + 1];
-        }
-
-        float value = 0.0f;
-        switch (mode) {
-        case ScopeWidget::ChannelLeft:
-            value = static_cast<float>(left) / 32768.0f;
-            break;
-        case ScopeWidget::ChannelRight:
-            value = static_cast<float>(right) / 32768.0f;
-            break;
-        case ScopeWidget::ChannelStereo:
-        default:
-            value = (static_cast<float>(left) + static_cast<float>(right)) / (2.0f * 32768.0f);
-            break;
-        }
-
-        samples.push_back(value);
-    }
-
-    return samples;
+    const int values = static_cast<int>(bytes / format.nBlockAlign) * format.nChannels;
+    const int offset = out.size();
+    out.resize(offset + values);
+    decodePcm16(pcm, values, out.data() + offset);
 }
-} // namespace
 
-BOOL CALLBACK ScopeWidget::enumDevicesCallback(LPGUID guid, LPCSTR description, LPCSTR, LPVOID context)
+// Splits the first two channels out of an interleaved block. Mono input
+// is mirrored into both.
+void splitChannels(const float *interleaved, int frames, int channels, QVector<float> &left, QVector<float> &right)
 {
-    auto *devices = reinterpret_cast<QVector<DeviceInfo> *>(context);
-    DeviceInfo info;
-    if (description && description[0] != '\0') {
-        info.name = QString::fromLocal8Bit(description);
-    } else {
-        info.name = QStringLiteral("DirectSound Capture Device");
-    }
-    if (guid) {
-        info.guid = *guid;
-        info.hasGuid = true;
+    left.resize(frames);
+    right.resize(frames);
+    for (int i = 0; i < frames; ++i) {
+        left[i] = interleaved[i * channels];
+        right[i] = (channels > 1) ? interleaved[i * channels + 1] : left[i];
     }
-    devices->push_back(info);
-    return TRUE;
 }
+} // namespace
 
 ScopeWidget::ScopeWidget(QWidget *parent)
     : QWidget(parent)
+    , m_pipeline(pipelineCallbacks())
 {
-    refreshDevices();
-    refreshOutputDevices();
     setMinimumHeight(240);
     setAutoFillBackground(false);
 
     m_timer.setInterval(30);
     connect(&m_timer, &QTimer::timeout, this, &ScopeWidget::pollCapture);
+
+    // Enumeration can take a noticeable time on machines with many
+    // endpoints, so it runs on the watcher thread and never blocks startup.
+    qRegisterMetaType<AudioDeviceInfo>("AudioDeviceInfo");
+    qRegisterMetaType<QVector<AudioDeviceInfo>>("QVector<AudioDeviceInfo>");
+    m_watcher = new DeviceWatcher;
+    m_watcher->moveToThread(&m_watcherThread);
+    connect(&m_watcherThread, &QThread::finished, m_watcher, &QObject::deleteLater);
+    connect(m_watcher, &DeviceWatcher::devicesChanged, this, &ScopeWidget::applyDevices);
+    m_watcherThread.start();
+    QMetaObject::invokeMethod(m_watcher, "start", Qt::QueuedConnection);
 }
 
 ScopeWidget::~ScopeWidget()
 {
+    m_watcherThread.quit();
+    m_watcherThread.wait();
     stopCapture();
+    stopRecording();
     releaseCapture();
+    releasePlayback();
+}
+
+CapturePipeline::Callbacks ScopeWidget::pipelineCallbacks()
+{
+    CapturePipeline::Callbacks callbacks;
+    callbacks.scope = [this](const GraphBlock &block) {
+        appendSamples(QVector<float>(block.mono, block.mono + block.frames));
+    };
+    callbacks.output = [this](const GraphBlock &block, const float *samples, bool *resynced) {
+        const int lead = outputSamples(QVector<float>(samples, samples + block.frames), resynced);
+        if (lead < 0) {
+            return -1.0;
+        }
+        // The emission is late by the playback lead plus the age of the
+        // captured block when it was written.
+        return lead + static_cast<double>(steadyNowNs() - block.timestampNs) * block.sampleRate / 1e9;
+    };
+    callbacks.analysis = [this](const GraphBlock &block) {
+        QVector<float> left;
+        QVector<float> right;
+        splitChannels(block.interleaved, block.frames, block.channels, left, right);
+        emit frameReady(QVector<float>(block.mono, block.mono + block.frames), block.sampleRate);
+        emit stereoFrameReady(left, right, block.sampleRate);
+    };
+    callbacks.spectrum = [this](const GraphBlock &block) {
+        emit spectrumReady(QVector<float>(block.spectrum, block.spectrum + block.spectrumBins), block.sampleRate,
+            block.firstFrame, block.timestampNs);
+    };
+    callbacks.loopbackFinished = [this](const LoopbackResult &result) {
+        emit loopbackFinished(result);
+    };
+    return callbacks;
 }
 
 QStringList ScopeWidget::deviceNames() const
@@ -118,6 +146,7 @@ void ScopeWidget::setDeviceIndex(int index)
 void ScopeWidget::setChannelMode(ChannelMode mode)
 {
     m_channelMode = mode;
+    m_pipeline.setMonoMix(static_cast<ProcessingGraph::MonoMix>(mode));
     update();
 }
 
@@ -147,6 +176,11 @@ void ScopeWidget::setOutputDeviceIndex(int index)
     }
 }
 
+void ScopeWidget::setFilterPreset(FilterChain::Preset preset)
+{
+    m_pipeline.setFilterPreset(preset);
+}
+
 bool ScopeWidget::startCapture()
 {
     stopCapture();
@@ -154,6 +188,7 @@ bool ScopeWidget::startCapture()
         emit statusChanged(QStringLiteral("Capture init failed"));
         return false;
     }
+    prepareStream(static_cast<int>(m_format.nSamplesPerSec), m_format.nChannels);
     initPlayback();
 
     HRESULT hr = m_buffer->Start(DSCBSTART_LOOPING);
@@ -164,6 +199,12 @@ bool ScopeWidget::startCapture()
         return false;
     }
 
+    DWORD readPos = 0;
+    m_buffer->GetCurrentPosition(nullptr, &readPos);
+    m_tracker.start(static_cast<int>(m_format.nSamplesPerSec), static_cast<int>(m_bufferBytes / m_format.nBlockAlign),
+        static_cast<int>(m_bufferBytes / m_format.nBlockAlign / 8), static_cast<int>(readPos / m_format.nBlockAlign),
+        steadyNowNs());
+
     m_timer.start();
     emit statusChanged(QStringLiteral("Capturing"));
     return true;
@@ -180,10 +221,138 @@ void ScopeWidget::stopCapture()
     if (m_playBuffer) {
         m_playBuffer->Stop();
     }
+    stopSessionRecording();
+    m_replay.close();
+    m_replayPending = false;
     m_wave.clear();
     update();
 }
 
+void ScopeWidget::prepareStream(int sampleRate, int channels)
+{
+    m_pipeline.prepare(sampleRate, channels);
+    m_timingClock.start();
+}
+
+int ScopeWidget::loadPlugins(const QString &directory, QStringList *errors)
+{
+    std::vector<std::string> messages;
+    std::vector<std::unique_ptr<BlockProcessor>> plugins = ::loadPlugins(directory.toStdString(), &messages);
+    if (errors) {
+        for (const std::string &message : messages) {
+            errors->append(QString::fromStdString(message));
+        }
+    }
+    int loaded = 0;
+    for (auto &plugin : plugins) {
+        const QString name = QString::fromStdString(plugin->name());
+        if (m_pipeline.addPlugin(std::move(plugin))) {
+            ++loaded;
+        } else if (errors) {
+            errors->append(QStringLiteral("%1: unsupported format").arg(name));
+        }
+    }
+    return loaded;
+}
+
+bool ScopeWidget::startRecording(const QString &path, QString *error)
+{
+    std::string message;
+    if (!m_pipeline.startRecording(path.toStdString(), &message)) {
+        if (error) {
+            *error = QString::fromStdString(message);
+        }
+        return false;
+    }
+    return true;
+}
+
+void ScopeWidget::stopRecording()
+{
+    m_pipeline.stopRecording();
+}
+
+bool ScopeWidget::startSessionRecording(const QString &path, QString *error)
+{
+    stopSessionRecording();
+    if (!m_buffer || !isCapturing() || isReplaying()) {
+        if (error) {
+            *error = QStringLiteral("Capture is not running");
+        }
+        return false;
+    }
+
+    std::string message;
+    if (!m_session.open(path.toStdString(), m_format.nChannels, static_cast<int>(m_format.nSamplesPerSec), &message)) {
+        if (error) {
+            *error = QString::fromStdString(message);
+        }
+        return false;
+    }
+    return true;
+}
+
+void ScopeWidget::stopSessionRecording()
+{
+    m_session.close();
+}
+
+bool ScopeWidget::startReplay(const QString &path, bool realTime, QString *error)
+{
+    stopCapture();
+
+    std::string message;
+    if (!m_replay.open(path.toStdString(), &message)) {
+        if (error) {
+            *error = QString::fromStdString(message);
+        }
+        return false;
+    }
+
+    // The rest of the widget reads the stream format from m_format.
+    m_format = WAVEFORMATEX{};
+    m_format.wFormatTag = WAVE_FORMAT_PCM;
+    m_format.nChannels = static_cast<WORD>(m_replay.channels());
+    m_format.nSamplesPerSec = static_cast<DWORD>(m_replay.sampleRate());
+    m_format.wBitsPerSample = 16;
+    m_format.nBlockAlign = static_cast<WORD>(m_format.nChannels * 2);
+    m_format.nAvgBytesPerSec = m_format.nSamplesPerSec * m_format.nBlockAlign;
+    prepareStream(m_replay.sampleRate(), m_replay.channels());
+
+    m_replayRealTime = realTime;
+    m_replayedBlocks = 0;
+    m_replayedFrames = 0;
+    m_replayPending = m_replay.next(m_replayBlock);
+    m_replayClock.start();
+    m_timer.start();
+    emit statusChanged(QStringLiteral("Replaying %1").arg(path));
+    return true;
+}
+
+void ScopeWidget::setGeneratorEnabled(bool enabled)
+{
+    m_pipeline.setGeneratorEnabled(enabled);
+}
+
+void ScopeWidget::setGeneratorType(SignalGenerator::Type type)
+{
+    m_pipeline.generator().setType(type);
+}
+
+void ScopeWidget::setGeneratorLevel(float level)
+{
+    m_pipeline.generator().setLevel(level);
+}
+
+bool ScopeWidget::startLoopbackMeasurement()
+{
+    if (!isCapturing() || !m_playBuffer || !m_pipeline.startLoopbackMeasurement()) {
+        return false;
+    }
+    m_playResync = true;
+    return true;
+}
+
 bool ScopeWidget::isCapturing() const
 {
     return m_timer.isActive();
@@ -243,107 +412,162 @@ void ScopeWidget::paintEvent(QPaintEvent *event)
 
 void ScopeWidget::pollCapture()
 {
+    if (isReplaying()) {
+        replayBlocks();
+        return;
+    }
     if (!m_buffer) {
         return;
     }
 
-    DWORD capturePos = 0;
     DWORD readPos = 0;
-    HRESULT hr = m_buffer->GetCurrentPosition(&capturePos, &readPos);
+    HRESULT hr = m_buffer->GetCurrentPosition(nullptr, &readPos);
     if (FAILED(hr)) {
         emit statusChanged(QStringLiteral("Capture read failed"));
         return;
     }
 
-    DWORD writePos = readPos;
-    if (writePos == m_readPos && capturePos != m_readPos) {
-        writePos = capturePos;
-    }
-
-    DWORD available = 0;
-    if (writePos >= m_readPos) {
-        available = writePos - m_readPos;
-    } else {
-        available = (m_bufferBytes - m_readPos) + writePos;
-    }
-
+    // Everything up to the read cursor is taken in one go, so a slow
+    // frame only makes the next block longer. Whatever the device has
+    // already overwritten comes back as a gap on the frame timeline.
     const DWORD blockAlign = m_format.nBlockAlign;
-    if (available < blockAlign) {
+    const int64_t pollNs = steadyNowNs();
+    int ringFrame = 0;
+    const CaptureBlock position = m_tracker.poll(static_cast<int>(readPos / blockAlign), pollNs, &ringFrame);
+    // A gap always comes with the frames still intact behind it, so an
+    // empty poll has nothing to report.
+    if (position.frames <= 0) {
         return;
     }
 
-    const DWORD maxBytes = static_cast<DWORD>(m_maxSamples) * blockAlign;
-    DWORD toRead = std::min(available, maxBytes);
-    toRead = (toRead / blockAlign) * blockAlign;
+    const DWORD readOffset = static_cast<DWORD>(ringFrame) * blockAlign;
+    const DWORD toRead = static_cast<DWORD>(position.frames) * blockAlign;
 
     void *ptr1 = nullptr;
     void *ptr2 = nullptr;
     DWORD bytes1 = 0;
     DWORD bytes2 = 0;
 
-    hr = m_buffer->Lock(m_readPos, toRead, &ptr1, &bytes1, &ptr2, &bytes2, 0);
+    hr = m_buffer->Lock(readOffset, toRead, &ptr1, &bytes1, &ptr2, &bytes2, 0);
     if (FAILED(hr)) {
         emit statusChanged(QStringLiteral("Capture lock failed"));
         return;
     }
 
-    QVector<float> samples;
+    QVector<float> interleaved;
     if (bytes1 > 0) {
-        samples = toSamples(ptr1, bytes1, m_format, m_channelMode);
+        appendInterleaved(interleaved, ptr1, bytes1, m_format);
     }
     if (bytes2 > 0) {
-        QVector<float> tail = toSamples(ptr2, bytes2, m_format, m_channelMode);
-        samples += tail;
+        appendInterleaved(interleaved, ptr2, bytes2, m_format);
+    }
+    if (m_session.isOpen()) {
+        m_session.write(pollNs, position, ptr1, bytes1, ptr2, bytes2);
     }
 
     m_buffer->Unlock(ptr1, bytes1, ptr2, bytes2);
 
-    if (!samples.isEmpty()) {
-        appendSamples(samples);
-        outputSamples(samples);
-        update();
-        emit frameReady(samples, static_cast<int>(m_format.nSamplesPerSec));
-    }
+    processCapture(position, interleaved);
+}
 
-    m_readPos = (m_readPos + toRead) % m_bufferBytes;
+void ScopeWidget::replayBlocks()
+{
+    // Real time releases every block whose recorded poll time has passed;
+    // otherwise blocks go through back to back, yielding once per timer
+    // interval so the widgets still repaint.
+    const qint64 budgetNs = static_cast<qint64>(m_timer.interval()) * 1000000;
+    QElapsedTimer tick;
+    tick.start();
+    QVector<float> interleaved;
+    while (m_replayPending) {
+        if (m_replayRealTime ? m_replayBlock.pollNs > m_replayClock.nsecsElapsed() : tick.nsecsElapsed() >= budgetNs) {
+            return;
+        }
+        interleaved.resize(static_cast<int>(m_replayBlock.pcm.size()));
+        decodePcm16(m_replayBlock.pcm.data(), interleaved.size(), interleaved.data());
+        processCapture(m_replayBlock.position, interleaved);
+        ++m_replayedBlocks;
+        m_replayedFrames += m_replayBlock.position.frames;
+        m_replayPending = m_replay.next(m_replayBlock);
+    }
+
+    const double audioMs = 1000.0 * static_cast<double>(m_replayedFrames) / m_format.nSamplesPerSec;
+    const double elapsedMs = static_cast<double>(m_replayClock.nsecsElapsed()) / 1e6;
+    const QString summary = QStringLiteral("Replayed %1 blocks, %2 s of audio in %3 s (%4x real time)")
+                                .arg(m_replayedBlocks)
+                                .arg(audioMs / 1000.0, 0, 'f', 1)
+                                .arg(elapsedMs / 1000.0, 0, 'f', 2)
+                                .arg((elapsedMs > 0.0) ? audioMs / elapsedMs : 0.0, 0, 'f', 1);
+    reportTimings();
+    stopCapture();
+    emit statusChanged(summary);
+    emit replayFinished(summary);
 }
 
-void ScopeWidget::refreshDevices()
+// Everything after the device read: live capture and replay both enter
+// here with one polled block. The pipeline filters a copy in place and
+// fans it out to its branches; rawFrameReady carries the unprocessed
+// capture.
+void ScopeWidget::processCapture(const CaptureBlock &position, const QVector<float> &interleaved)
 {
-    m_devices.clear();
-    DirectSoundCaptureEnumerateA(enumDevicesCallback, &m_devices);
+    if (position.droppedFrames > 0) {
+        emit captureGap(position.firstFrame, position.droppedFrames);
+    }
+    if (interleaved.isEmpty()) {
+        return;
+    }
+
+    const int channels = m_format.nChannels;
+    emit rawFrameReady(interleaved, channels, static_cast<int>(m_format.nSamplesPerSec), position.firstFrame,
+        position.timestampNs);
+    QVector<float> processed = interleaved;
+    m_pipeline.process(position, processed.data(), processed.size() / channels);
+    update();
 
-    if (m_devices.isEmpty()) {
-        DeviceInfo fallback;
-        fallback.name = QStringLiteral("Default device");
-        fallback.hasGuid = false;
-        m_devices.push_back(fallback);
+    if (m_timingClock.hasExpired(1000)) {
+        reportTimings();
+        m_timingClock.restart();
     }
-    m_deviceIndex = 0;
 }
 
-void ScopeWidget::refreshOutputDevices()
+void ScopeWidget::applyDevices(const QVector<AudioDeviceInfo> &inputs, const QVector<AudioDeviceInfo> &outputs)
 {
-    m_outputDevices.clear();
-    DirectSoundEnumerateA(enumDevicesCallback, &m_outputDevices);
+    const AudioDeviceInfo currentInput = m_devices.value(m_deviceIndex);
+    const AudioDeviceInfo currentOutput = m_outputDevices.value(m_outputDeviceIndex);
+    const bool hadDevices = m_devicesReady;
 
+    // No capture fallback: an empty list leaves Start disabled.
+    m_devices = inputs;
+    m_outputDevices = outputs;
     if (m_outputDevices.isEmpty()) {
-        DeviceInfo fallback;
+        AudioDeviceInfo fallback;
         fallback.name = QStringLiteral("Default output");
-        fallback.hasGuid = false;
         m_outputDevices.push_back(fallback);
     }
-    m_outputDeviceIndex = 0;
+    m_devicesReady = true;
+
+    const int inputIndex = m_devices.indexOf(currentInput);
+    const int outputIndex = m_outputDevices.indexOf(currentOutput);
+    m_deviceIndex = std::max(0, inputIndex);
+    m_outputDeviceIndex = std::max(0, outputIndex);
+
+    if (hadDevices && isCapturing() && inputIndex < 0) {
+        stopCapture();
+        releaseCapture();
+        releasePlayback();
+        emit statusChanged(QStringLiteral("Capture device removed"));
+    } else if (hadDevices && isCapturing() && outputIndex < 0) {
+        initPlayback();
+    }
+
+    emit devicesChanged();
 }
 
 bool ScopeWidget::initCapture()
 {
     releaseCapture();
-    if (m_devices.isEmpty()) {
-        refreshDevices();
-    }
 
-    const DeviceInfo &device = m_devices.value(m_deviceIndex);
+    const AudioDeviceInfo device = m_devices.value(m_deviceIndex);
     HRESULT hr = DirectSoundCaptureCreate8(device.hasGuid ? &device.guid : nullptr, &m_capture, nullptr);
     if (FAILED(hr)) {
         return false;
@@ -368,11 +592,8 @@ bool ScopeWidget::initCapture()
 bool ScopeWidget::initPlayback()
 {
     releasePlayback();
-    if (m_outputDevices.isEmpty()) {
-        refreshOutputDevices();
-    }
 
-    const DeviceInfo &device = m_outputDevices.value(m_outputDeviceIndex);
+    const AudioDeviceInfo device = m_outputDevices.value(m_outputDeviceIndex);
     HRESULT hr = DirectSoundCreate8(device.hasGuid ? &device.guid : nullptr, &m_play, nullptr);
     if (FAILED(hr) || !m_play) {
         emit statusChanged(QStringLiteral("Playback init failed"));
@@ -405,6 +626,7 @@ bool ScopeWidget::initPlayback()
     m_playBuffer = buffer;
     m_playBufferBytes = desc.dwBufferBytes;
     m_playWritePos = 0;
+    m_playResync = true;
 
     void *ptr1 = nullptr;
     void *ptr2 = nullptr;
@@ -435,7 +657,6 @@ void ScopeWidget::releaseCapture()
         m_capture = nullptr;
     }
     m_bufferBytes = 0;
-    m_readPos = 0;
 }
 
 void ScopeWidget::releasePlayback()
@@ -488,22 +709,67 @@ bool ScopeWidget::tryFormat(int sampleRate, int channels, int bitsPerSample)
     m_buffer = buffer8;
     m_format = format;
     m_bufferBytes = desc.dwBufferBytes;
-    m_readPos = 0;
     return true;
 }
 
+void ScopeWidget::reportTimings()
+{
+    ProcessingGraph &graph = m_pipeline.graph();
+    const std::vector<NodeTiming> timings = graph.timings();
+    graph.resetTimings();
+
+    QStringList lines;
+    const NodeTiming *slowest = nullptr;
+    for (const NodeTiming &timing : timings) {
+        if (timing.calls == 0) {
+            continue;
+        }
+        lines.append(QStringLiteral("%1: %2 ms avg, %3 ms max over %4 blocks")
+                         .arg(QString::fromStdString(timing.name))
+                         .arg(timing.averageMs(), 0, 'f', 3)
+                         .arg(timing.maxMs, 0, 'f', 3)
+                         .arg(timing.calls));
+        if (!slowest || timing.averageMs() > slowest->averageMs()) {
+            slowest = &timing;
+        }
+    }
+    if (!slowest) {
+        return;
+    }
+
+    if (!isReplaying()) {
+        const double rate = static_cast<double>(m_tracker.sampleRate());
+        lines.append(QStringLiteral("capture: %1 frames read, %2 dropped in %3 gaps, %4 ms max backlog")
+                         .arg(m_tracker.framesRead())
+                         .arg(m_tracker.droppedFrames())
+                         .arg(m_tracker.gapCount())
+                         .arg(1000.0 * static_cast<double>(m_tracker.maxBacklogFrames()) / rate, 0, 'f', 1));
+    }
+
+    const int latency = graph.latencyFrames();
+    if (latency > 0 && graph.sampleRate() > 0) {
+        lines.append(QStringLiteral("processing latency: %1 frames (%2 ms), compensated in stamps")
+                         .arg(latency)
+                         .arg(1000.0 * latency / graph.sampleRate(), 0, 'f', 1));
+    }
+
+    QString summary = QStringLiteral("Slowest node: %1 (%2 ms/block)")
+                          .arg(QString::fromStdString(slowest->name))
+                          .arg(slowest->averageMs(), 0, 'f', 3);
+    if (!isReplaying() && m_tracker.gapCount() > 0) {
+        summary += QStringLiteral(", %1 capture gaps").arg(m_tracker.gapCount());
+    }
+    emit graphTimingsChanged(summary, lines.join(QLatin1Char('\n')));
+}
+
 void ScopeWidget::appendSamples(const QVector<float> &samples)
 {
     QVector<float> absSamples;
     absSamples.reserve(samples.size());
 
-    float maxAbs = 0.0f;
     for (float sample : samples) {
-        const float value = std::fabs(sample);
-        absSamples.push_back(value);
-        maxAbs = std::max(maxAbs, value);
+        absSamples.push_back(std::fabs(sample));
     }
-    m_displayPeak = std::max(maxAbs, m_displayPeak * 0.95f);
 
     if (absSamples.size() >= m_maxSamples) {
         m_wave = absSamples.mid(absSamples.size() - m_maxSamples);
@@ -517,10 +783,13 @@ void ScopeWidget::appendSamples(const QVector<float> &samples)
     m_wave += absSamples;
 }
 
-void ScopeWidget::outputSamples(const QVector<float> &samples)
+int ScopeWidget::outputSamples(const QVector<float> &samples, bool *resynced)
 {
+    if (resynced) {
+        *resynced = false;
+    }
     if (!m_playBuffer || m_format.wBitsPerSample != 16) {
-        return;
+        return -1;
     }
 
     QVector<int16_t> pcm;
@@ -541,7 +810,46 @@ void ScopeWidget::outputSamples(const QVector<float> &samples)
 
     const DWORD bytesToWrite = static_cast<DWORD>(pcm.size() * sizeof(int16_t));
     const DWORD alignedBytes = (bytesToWrite / m_format.nBlockAlign) * m_format.nBlockAlign;
-    if (alignedBytes == 0) {
+    if (alignedBytes == 0 || alignedBytes >= m_playBufferBytes / 2) {
+        return -1;
+    }
+
+    DWORD playCursor = 0;
+    DWORD safeCursor = 0;
+    if (FAILED(m_playBuffer->GetCurrentPosition(&playCursor, &safeCursor))) {
+        return -1;
+    }
+
+    // Blocks follow each other back to back while the write position stays
+    // between the safe cursor and twice the lead; otherwise (at start, after
+    // an underrun, or when capture outpaces playback) it is re-anchored at
+    // the play cursor plus the lead, with silence up to there.
+    const DWORD size = m_playBufferBytes;
+    const DWORD align = m_format.nBlockAlign;
+    const DWORD lead = std::max<DWORD>(align, m_format.nAvgBytesPerSec * kPlayLeadMs / 1000 / align * align);
+    const DWORD safe = (safeCursor + size - playCursor) % size;
+    const DWORD ahead = (m_playWritePos + size - playCursor) % size;
+    if (m_playResync || ahead < safe || ahead > 2 * lead + alignedBytes) {
+        const DWORD silenceFrom = (playCursor + safe) / align * align % size;
+        m_playWritePos = (playCursor / align * align + std::max(lead, safe + align)) % size;
+        writePlayback(silenceFrom, nullptr, (m_playWritePos + size - silenceFrom) % size);
+        m_playResync = false;
+        if (resynced) {
+            *resynced = true;
+        }
+    }
+
+    const int leadFrames = static_cast<int>(((m_playWritePos + size - playCursor) % size) / align);
+    writePlayback(m_playWritePos, pcm.constData(), alignedBytes);
+    m_playWritePos = (m_playWritePos + alignedBytes) % size;
+    return leadFrames;
+}
+
+// Copies into the looping play buffer at `position`, wrapping as needed; a
+// null `data` writes silence.
+void ScopeWidget::writePlayback(DWORD position, const void *data, DWORD bytes)
+{
+    if (bytes == 0) {
         return;
     }
 
@@ -549,19 +857,24 @@ void ScopeWidget::outputSamples(const QVector<float> &samples)
     void *ptr2 = nullptr;
     DWORD bytes1 = 0;
     DWORD bytes2 = 0;
-    HRESULT hr = m_playBuffer->Lock(m_playWritePos, alignedBytes, &ptr1, &bytes1, &ptr2, &bytes2, 0);
-    if (FAILED(hr)) {
+    if (FAILED(m_playBuffer->Lock(position, bytes, &ptr1, &bytes1, &ptr2, &bytes2, 0))) {
         return;
     }
 
-    const uint8_t *src = reinterpret_cast<const uint8_t *>(pcm.constData());
+    const uint8_t *src = reinterpret_cast<const uint8_t *>(data);
     if (ptr1 && bytes1) {
-        std::memcpy(ptr1, src, bytes1);
+        if (src) {
+            std::memcpy(ptr1, src, bytes1);
+        } else {
+            std::memset(ptr1, 0, bytes1);
+        }
     }
     if (ptr2 && bytes2) {
-        std::memcpy(ptr2, src + bytes1, bytes2);
+        if (src) {
+            std::memcpy(ptr2, src + bytes1, bytes2);
+        } else {
+            std::memset(ptr2, 0, bytes2);
+        }
     }
     m_playBuffer->Unlock(ptr1, bytes1, ptr2, bytes2);
-
-    m_playWritePos = (m_playWritePos + alignedBytes) % m_playBufferBytes;
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QString>
 #include <QStringList>
+#include <QThread>
 #include <QTimer>
 #include <QVector>
 #include <QWidget>
@@ -9,6 +11,11 @@
 #include <windows.h>
 #include <dsound.h>
 
+#include "capturepipeline.h"
+#include "capturesession.h"
+#include "capturetracker.h"
+#include "devicewatcher.h"
+
 class ScopeWidget : public QWidget
 {
     Q_OBJECT
@@ -25,48 +32,101 @@ public:
 
     QStringList deviceNames() const;
     QStringList outputDeviceNames() const;
+    int deviceIndex() const { return m_deviceIndex; }
+    int outputDeviceIndex() const { return m_outputDeviceIndex; }
+    bool devicesReady() const { return m_devicesReady; }
     void setDeviceIndex(int index);
     void setChannelMode(ChannelMode mode);
     void setTimeScaleMs(int ms);
     void setGain(float gain);
     void setOutputDeviceIndex(int index);
+    void setFilterPreset(FilterChain::Preset preset);
 
     bool startCapture();
     void stopCapture();
     bool isCapturing() const;
 
+    // Appends every plugin in `directory` to the processing graph after
+    // the filter chain. Returns the number of plugins added.
+    int loadPlugins(const QString &directory, QStringList *errors = nullptr);
+
+    // Records the processed stream as 16-bit WAV; capture must be running.
+    bool startRecording(const QString &path, QString *error = nullptr);
+    void stopRecording();
+    bool isRecording() const { return m_pipeline.isRecording(); }
+
+    // Saves every raw capture block with the time it was polled, so the
+    // session can be replayed later; capture must be running.
+    bool startSessionRecording(const QString &path, QString *error = nullptr);
+    void stopSessionRecording();
+    bool isRecordingSession() const { return m_session.isOpen(); }
+
+    // Feeds a recorded session through the same path as live capture,
+    // at the recorded pace or as fast as the graph keeps up. Stops any
+    // running capture; replayFinished reports the run.
+    bool startReplay(const QString &path, bool realTime, QString *error = nullptr);
+    bool isReplaying() const { return m_replay.isOpen(); }
+
+    // With the generator enabled the output plays the test signal instead
+    // of echoing the input.
+    void setGeneratorEnabled(bool enabled);
+    void setGeneratorType(SignalGenerator::Type type);
+    void setGeneratorLevel(float level);
+    bool isGeneratorEnabled() const { return m_pipeline.isGeneratorEnabled(); }
+
+    // Records the emitted and returned streams in lockstep and emits
+    // loopbackFinished when the analysis is done. The generator must be
+    // enabled and the output cabled (or routed) back to the input.
+    bool startLoopbackMeasurement();
+
 signals:
     void statusChanged(const QString &text);
+    void devicesChanged();
     void frameReady(const QVector<float> &samples, int sampleRate);
+    void stereoFrameReady(const QVector<float> &left, const QVector<float> &right, int sampleRate);
+    void rawFrameReady(const QVector<float> &interleaved, int channels, int sampleRate, qint64 firstFrame,
+        qint64 timestampNs);
+    // Stamped with the graph block the spectrum was computed at.
+    void spectrumReady(const QVector<float> &bins, int sampleRate, qint64 firstFrame, qint64 timestampNs);
+    void graphTimingsChanged(const QString &summary, const QString &details);
+    void loopbackFinished(const LoopbackResult &result);
+    // The reader fell a whole capture buffer behind; `droppedFrames` frames
+    // just before device frame `firstFrame` were overwritten unread.
+    void captureGap(qint64 firstFrame, qint64 droppedFrames);
+    void replayFinished(const QString &summary);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
 
 private slots:
     void pollCapture();
+    void applyDevices(const QVector<AudioDeviceInfo> &inputs, const QVector<AudioDeviceInfo> &outputs);
 
 private:
-    struct DeviceInfo {
-        QString name;
-        GUID guid{};
-        bool hasGuid = false;
-    };
-
-    static BOOL CALLBACK enumDevicesCallback(LPGUID guid, LPCSTR description, LPCSTR module, LPVOID context);
-    void refreshDevices();
-    void refreshOutputDevices();
+    CapturePipeline::Callbacks pipelineCallbacks();
     bool initCapture();
     bool initPlayback();
     void releaseCapture();
     void releasePlayback();
     bool tryFormat(int sampleRate, int channels, int bitsPerSample);
+    void prepareStream(int sampleRate, int channels);
+    void processCapture(const CaptureBlock &position, const QVector<float> &interleaved);
+    void replayBlocks();
     void appendSamples(const QVector<float> &samples);
-    void outputSamples(const QVector<float> &samples);
+    // Returns how many frames ahead of the play cursor the block was
+    // written, or -1 if it was not. `resynced` reports a jump of the write
+    // position back to the fixed lead.
+    int outputSamples(const QVector<float> &samples, bool *resynced = nullptr);
+    void writePlayback(DWORD position, const void *data, DWORD bytes);
+    void reportTimings();
 
-    QVector<DeviceInfo> m_devices;
+    QVector<AudioDeviceInfo> m_devices;
     int m_deviceIndex = 0;
-    QVector<DeviceInfo> m_outputDevices;
+    QVector<AudioDeviceInfo> m_outputDevices;
     int m_outputDeviceIndex = 0;
+    bool m_devicesReady = false;
+    QThread m_watcherThread;
+    DeviceWatcher *m_watcher = nullptr;
     ChannelMode m_channelMode = ChannelStereo;
 
     IDirectSoundCapture8 *m_capture = nullptr;
@@ -75,14 +135,26 @@ private:
     IDirectSoundBuffer *m_playBuffer = nullptr;
     WAVEFORMATEX m_format{};
     DWORD m_bufferBytes = 0;
-    DWORD m_readPos = 0;
     DWORD m_playBufferBytes = 0;
     DWORD m_playWritePos = 0;
+    bool m_playResync = true;
+
+    CapturePipeline m_pipeline;
+    CaptureTracker m_tracker;
+    CaptureSessionWriter m_session;
+
+    CaptureSessionReader m_replay;
+    CaptureSessionBlock m_replayBlock;
+    bool m_replayPending = false;
+    bool m_replayRealTime = true;
+    long long m_replayedBlocks = 0;
+    long long m_replayedFrames = 0;
+    QElapsedTimer m_replayClock;
+    QElapsedTimer m_timingClock;
 
     QTimer m_timer;
     QVector<float> m_wave;
     int m_maxSamples = 2048;
-    float m_displayPeak = 0.05f;
     float m_gain = 10.0f;
     int m_timeScaleMs = 0;
 };
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Memory layout of the shared frame ring. The writer and every reader map
+// the same object, so this header is the whole contract between them.
+//
+// Each slot is guarded by a sequence lock: the writer stores 2 * frame + 1
+// before touching a slot and 2 * frame + 2 once the payload is complete. A
+// reader that sees the same even value before and after copying knows the
+// copy is not torn.
+//
+// The writer stores the magic with release once the ring is initialised
+// and clears it when the ring is closed or replaced; readers load it with
+// acquire. The generation goes up each time a ring is created under the
+// same name, so a reader still mapped to memory the writer reinitialised
+// can tell that the frame numbers started over.
+namespace SharedFrame {
+
+constexpr uint32_t kMagic = 0x52465653; // "SVFR"
+constexpr uint32_t kVersion = 2;
+constexpr const char *kDefaultName = "/scopevibe-frames";
+
+enum Kind : uint32_t {
+    KindSamples = 1,  // interleaved float samples, count = frames
+    KindSpectrum = 2  // magnitude bins per channel, count = bins
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+    "shared ring needs lock-free 32- and 64-bit atomics");
+
+struct RingHeader {
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotBytes;
+    std::atomic<uint64_t> published;
+    std::atomic<uint64_t> generation;
+};
+
+struct SlotHeader {
+    std::atomic<uint64_t> sequence;
+    uint32_t kind;
+    uint32_t channels;
+    uint32_t count;
+    uint32_t sampleRate;
+    uint64_t firstSample;
+    uint64_t timestampNs;
+    uint32_t payloadBytes;
+    uint32_t reserved;
+};
+
+constexpr size_t align64(size_t value)
+{
+    return (value + 63) & ~static_cast<size_t>(63);
+}
+
+constexpr size_t headerBytes()
+{
+    return align64(sizeof(RingHeader));
+}
+
+constexpr size_t slotStride(uint32_t slotBytes)
+{
+    return align64(sizeof(SlotHeader)) + align64(slotBytes);
+}
+
+constexpr size_t mappingBytes(uint32_t slotCount, uint32_t slotBytes)
+{
+    return headerBytes() + static_cast<size_t>(slotCount) * slotStride(slotBytes);
+}
+
+inline SlotHeader *slotAt(void *base, uint32_t slotBytes, uint64_t frame, uint32_t slotCount)
+{
+    return reinterpret_cast<SlotHeader *>(static_cast<uint8_t *>(base) + headerBytes()
+        + static_cast<size_t>(frame % slotCount) * slotStride(slotBytes));
+}
+
+inline const float *slotPayload(const SlotHeader *slot)
+{
+    return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(slot) + align64(sizeof(SlotHeader)));
+}
+
+} // namespace SharedFrame
@@ -0,0 +1,157 @@
+#include "sharedframereader.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool SharedFrameReader::open(const std::string &name, std::string *error)
+{
+    close();
+    if (!m_memory.open(name, false, error)) {
+        return false;
+    }
+
+    const auto *header = static_cast<const SharedFrame::RingHeader *>(m_memory.data());
+    const bool valid = m_memory.size() >= SharedFrame::headerBytes()
+        && header->magic.load(std::memory_order_acquire) == SharedFrame::kMagic
+        && header->version == SharedFrame::kVersion && header->slotCount > 0
+        && m_memory.size() >= SharedFrame::mappingBytes(header->slotCount, header->slotBytes);
+    if (!valid) {
+        m_memory.close();
+        if (error) {
+            *error = "shared memory does not hold a compatible frame ring";
+        }
+        return false;
+    }
+
+    m_header = header;
+    m_slotCount = header->slotCount;
+    m_slotBytes = header->slotBytes;
+    m_generation = header->generation.load(std::memory_order_relaxed);
+    seekToLatest();
+    m_lost = 0;
+    return true;
+}
+
+void SharedFrameReader::close()
+{
+    m_memory.close();
+    m_header = nullptr;
+    m_slotCount = 0;
+    m_slotBytes = 0;
+    m_generation = 0;
+    m_cursor = 0;
+    m_lost = 0;
+}
+
+bool SharedFrameReader::isCurrent() const
+{
+    return m_header && m_header->magic.load(std::memory_order_acquire) == SharedFrame::kMagic
+        && m_header->generation.load(std::memory_order_relaxed) == m_generation;
+}
+
+uint64_t SharedFrameReader::published() const
+{
+    return m_header ? m_header->published.load(std::memory_order_acquire) : 0;
+}
+
+uint64_t SharedFrameReader::oldestAvailable() const
+{
+    const uint64_t count = published();
+    return (count > m_slotCount) ? count - m_slotCount : 0;
+}
+
+SharedFrameReader::Status SharedFrameReader::view(uint64_t frame, View &view) const
+{
+    if (!m_header) {
+        return StatusNotReady;
+    }
+    if (!isCurrent()) {
+        return StatusReopen;
+    }
+
+    const auto *slot = SharedFrame::slotAt(m_memory.data(), m_slotBytes, frame, m_slotCount);
+    const uint64_t expected = 2 * frame + 2;
+    const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence < expected) {
+        return StatusNotReady;
+    }
+    if (sequence != expected) {
+        return StatusOverwritten;
+    }
+
+    view.slot = slot;
+    view.data = SharedFrame::slotPayload(slot);
+    view.info.frame = frame;
+    view.info.kind = static_cast<SharedFrame::Kind>(slot->kind);
+    view.info.channels = static_cast<int>(slot->channels);
+    view.info.count = static_cast<int>(std::min<uint32_t>(slot->count,
+        slot->channels ? m_slotBytes / (sizeof(float) * slot->channels) : 0));
+    view.info.sampleRate = static_cast<int>(slot->sampleRate);
+    view.info.firstSample = slot->firstSample;
+    view.info.timestampNs = slot->timestampNs;
+    if (!isValid(view)) {
+        return isCurrent() ? StatusOverwritten : StatusReopen;
+    }
+    return StatusOk;
+}
+
+bool SharedFrameReader::isValid(const View &view) const
+{
+    if (!view.slot) {
+        return false;
+    }
+    // A recreated ring numbers its frames from zero again, so a matching
+    // sequence only counts within the generation this reader opened.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return view.slot->sequence.load(std::memory_order_relaxed) == 2 * view.info.frame + 2
+        && m_header->magic.load(std::memory_order_relaxed) == SharedFrame::kMagic
+        && m_header->generation.load(std::memory_order_relaxed) == m_generation;
+}
+
+SharedFrameReader::Status SharedFrameReader::read(uint64_t frame, SharedFrameInfo &info, std::vector<float> &data) const
+{
+    View slotView;
+    const Status status = view(frame, slotView);
+    if (status != StatusOk) {
+        return status;
+    }
+
+    const size_t values = static_cast<size_t>(slotView.info.channels) * slotView.info.count;
+    data.resize(values);
+    std::memcpy(data.data(), slotView.data, values * sizeof(float));
+    if (!isValid(slotView)) {
+        return isCurrent() ? StatusOverwritten : StatusReopen;
+    }
+    info = slotView.info;
+    return StatusOk;
+}
+
+SharedFrameReader::Status SharedFrameReader::next(SharedFrameInfo &info, std::vector<float> &data)
+{
+    for (;;) {
+        if (!isCurrent()) {
+            return StatusReopen;
+        }
+        const uint64_t oldest = oldestAvailable();
+        if (m_cursor < oldest) {
+            m_lost += oldest - m_cursor;
+            m_cursor = oldest;
+        }
+
+        const Status status = read(m_cursor, info, data);
+        if (status == StatusOverwritten) {
+            ++m_lost;
+            ++m_cursor;
+            continue;
+        }
+        if (status == StatusOk) {
+            ++m_cursor;
+        }
+        return status;
+    }
+}
+
+void SharedFrameReader::seekToLatest()
+{
+    m_cursor = published();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "sharedframelayout.h"
+#include "sharedmemory.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SharedFrameInfo {
+    uint64_t frame = 0;
+    SharedFrame::Kind kind = SharedFrame::KindSamples;
+    int channels = 0;
+    int count = 0;
+    int sampleRate = 0;
+    uint64_t firstSample = 0;
+    uint64_t timestampNs = 0;
+};
+
+// Reader for the shared frame ring. Any number of readers can attach; none
+// of them can slow down or block the writer.
+class SharedFrameReader
+{
+public:
+    enum Status {
+        StatusOk = 0,
+        StatusNotReady = 1,   // frame not published yet
+        StatusOverwritten = 2, // writer lapped the reader or a copy was torn
+        StatusReopen = 3       // writer closed or recreated the ring; close() and open() again
+    };
+
+    // A zero-copy view into a slot. The data is only trustworthy if
+    // isValid() still returns true after the caller is done with it.
+    struct View {
+        SharedFrameInfo info;
+        const float *data = nullptr;
+        const SharedFrame::SlotHeader *slot = nullptr;
+    };
+
+    bool open(const std::string &name = SharedFrame::kDefaultName, std::string *error = nullptr);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+    // False once the writer has closed or recreated the ring this reader
+    // opened; every call then returns StatusReopen.
+    bool isCurrent() const;
+    uint64_t generation() const { return m_generation; }
+
+    uint64_t published() const;
+    uint64_t oldestAvailable() const;
+
+    Status view(uint64_t frame, View &view) const;
+    bool isValid(const View &view) const;
+
+    // Copies a frame into caller-owned storage; data is resized as needed.
+    Status read(uint64_t frame, SharedFrameInfo &info, std::vector<float> &data) const;
+
+    // Cursor-based consumption: returns the next frame after the last one
+    // returned, skipping ahead (and counting lost frames) when lapped.
+    Status next(SharedFrameInfo &info, std::vector<float> &data);
+    void seekToLatest();
+    uint64_t lostFrames() const { return m_lost; }
+
+private:
+    SharedMemory m_memory;
+    const SharedFrame::RingHeader *m_header = nullptr;
+    uint32_t m_slotCount = 0;
+    uint32_t m_slotBytes = 0;
+    uint64_t m_generation = 0;
+    uint64_t m_cursor = 0;
+    uint64_t m_lost = 0;
+};
@@ -0,0 +1,116 @@
+#include "sharedframering.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+bool SharedFrameRing::create(const std::string &name, uint32_t slotCount, uint32_t slotBytes, std::string *error)
+{
+    close();
+
+    // Retire whatever ring is still under this name, even one left by a
+    // writer that crashed: readers mapped to it see the magic cleared, and
+    // the new ring continues its generation count.
+    uint64_t generation = 1;
+    SharedMemory previous;
+    if (previous.open(name, true) && previous.size() >= SharedFrame::headerBytes()) {
+        auto *old = static_cast<SharedFrame::RingHeader *>(previous.data());
+        if (old->magic.load(std::memory_order_acquire) == SharedFrame::kMagic && old->version == SharedFrame::kVersion) {
+            generation = old->generation.load(std::memory_order_relaxed) + 1;
+        }
+        old->magic.store(0, std::memory_order_release);
+    }
+    previous.close();
+
+    slotCount = std::max<uint32_t>(2, slotCount);
+    slotBytes = std::max<uint32_t>(1024, slotBytes);
+    const size_t bytes = SharedFrame::mappingBytes(slotCount, slotBytes);
+    if (!m_memory.create(name, bytes, error)) {
+        return false;
+    }
+
+    std::memset(m_memory.data(), 0, bytes);
+    m_header = new (m_memory.data()) SharedFrame::RingHeader;
+    m_header->slotCount = slotCount;
+    m_header->slotBytes = slotBytes;
+    m_header->version = SharedFrame::kVersion;
+    m_header->published.store(0, std::memory_order_relaxed);
+    m_header->generation.store(generation, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < slotCount; ++i) {
+        auto *slot = new (SharedFrame::slotAt(m_memory.data(), slotBytes, i, slotCount)) SharedFrame::SlotHeader;
+        slot->sequence.store(0, std::memory_order_relaxed);
+    }
+    m_slotCount = slotCount;
+    m_slotBytes = slotBytes;
+
+    // Readers check the magic first, so it must become visible after the rest.
+    m_header->magic.store(SharedFrame::kMagic, std::memory_order_release);
+    return true;
+}
+
+void SharedFrameRing::close()
+{
+    if (m_header) {
+        m_header->magic.store(0, std::memory_order_release);
+    }
+    m_memory.close();
+    m_header = nullptr;
+    m_slotCount = 0;
+    m_slotBytes = 0;
+}
+
+int SharedFrameRing::publish(SharedFrame::Kind kind, int channels, int count, int sampleRate, uint64_t firstSample,
+    const float *data, uint64_t timestampNs)
+{
+    if (!m_header || channels <= 0 || count <= 0 || !data) {
+        return 0;
+    }
+
+    if (timestampNs == 0) {
+        timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    const int capacity = static_cast<int>(m_slotBytes / (sizeof(float) * channels));
+    if (capacity <= 0) {
+        return 0;
+    }
+
+    if (kind != SharedFrame::KindSamples) {
+        writeSlot(kind, channels, std::min(count, capacity), sampleRate, firstSample, timestampNs, data);
+        return 1;
+    }
+
+    int written = 0;
+    for (int offset = 0; offset < count; offset += capacity) {
+        const int chunk = std::min(capacity, count - offset);
+        const uint64_t offsetNs = (sampleRate > 0) ? static_cast<uint64_t>(offset) * 1000000000ULL / sampleRate : 0;
+        writeSlot(kind, channels, chunk, sampleRate, firstSample + offset, timestampNs + offsetNs,
+            data + static_cast<size_t>(offset) * channels);
+        ++written;
+    }
+    return written;
+}
+
+void SharedFrameRing::writeSlot(SharedFrame::Kind kind, int channels, int count, int sampleRate, uint64_t firstSample,
+    uint64_t timestampNs, const float *data)
+{
+    const uint64_t frame = m_header->published.load(std::memory_order_relaxed);
+    SharedFrame::SlotHeader *slot = SharedFrame::slotAt(m_memory.data(), m_slotBytes, frame, m_slotCount);
+
+    slot->sequence.store(2 * frame + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const uint32_t bytes = static_cast<uint32_t>(sizeof(float) * static_cast<size_t>(channels) * count);
+    slot->kind = kind;
+    slot->channels = static_cast<uint32_t>(channels);
+    slot->count = static_cast<uint32_t>(count);
+    slot->sampleRate = static_cast<uint32_t>(sampleRate);
+    slot->firstSample = firstSample;
+    slot->timestampNs = timestampNs;
+    slot->payloadBytes = bytes;
+    std::memcpy(const_cast<float *>(SharedFrame::slotPayload(slot)), data, bytes);
+
+    slot->sequence.store(2 * frame + 2, std::memory_order_release);
+    m_header->published.store(frame + 1, std::memory_order_release);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "sharedframelayout.h"
+#include "sharedmemory.h"
+
+#include <cstdint>
+#include <string>
+
+// Single-producer side of the shared frame ring. publish() never waits for
+// readers; a reader that falls more than slotCount frames behind simply
+// sees the frames it missed as overwritten.
+class SharedFrameRing
+{
+public:
+    bool create(const std::string &name = SharedFrame::kDefaultName, uint32_t slotCount = 128,
+        uint32_t slotBytes = 128 * 1024, std::string *error = nullptr);
+    void close();
+    bool isOpen() const { return m_memory.isOpen(); }
+
+    // Publishes count entries per channel. Sample blocks larger than a slot
+    // are split across consecutive frames; spectra are truncated to fit.
+    // Returns the number of frames written. A zero timestamp stamps the
+    // frames with the current steady-clock time.
+    int publish(SharedFrame::Kind kind, int channels, int count, int sampleRate, uint64_t firstSample,
+        const float *data, uint64_t timestampNs = 0);
+
+private:
+    void writeSlot(SharedFrame::Kind kind, int channels, int count, int sampleRate, uint64_t firstSample,
+        uint64_t timestampNs, const float *data);
+
+    SharedMemory m_memory;
+    SharedFrame::RingHeader *m_header = nullptr;
+    uint32_t m_slotCount = 0;
+    uint32_t m_slotBytes = 0;
+};
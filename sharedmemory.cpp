@@ -0,0 +1,151 @@
+#include "sharedmemory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+namespace {
+bool fail(std::string *error, const std::string &message)
+{
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+#ifdef _WIN32
+std::string mappingName(const std::string &name)
+{
+    return std::string("Local\\") + (name.empty() || name[0] != '/' ? name : name.substr(1));
+}
+#else
+std::string systemError(const char *what)
+{
+    return std::string(what) + ": " + std::strerror(errno);
+}
+#endif
+} // namespace
+
+SharedMemory::~SharedMemory()
+{
+    close();
+}
+
+bool SharedMemory::create(const std::string &name, size_t bytes, std::string *error)
+{
+    close();
+
+#ifdef _WIN32
+    const unsigned long long size = bytes;
+    HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFFu), mappingName(name).c_str());
+    if (!handle) {
+        return fail(error, "CreateFileMapping failed");
+    }
+    void *data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!data) {
+        CloseHandle(handle);
+        return fail(error, "MapViewOfFile failed");
+    }
+    m_handle = handle;
+#else
+    // Start from a fresh object so readers never see a stale layout.
+    shm_unlink(name.c_str());
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        return fail(error, systemError("shm_open"));
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        const std::string message = systemError("ftruncate");
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return fail(error, message);
+    }
+    void *data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return fail(error, systemError("mmap"));
+    }
+#endif
+
+    m_name = name;
+    m_data = data;
+    m_size = bytes;
+    m_owner = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string &name, bool writable, std::string *error)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE handle = OpenFileMappingA(writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, FALSE, mappingName(name).c_str());
+    if (!handle) {
+        return fail(error, "OpenFileMapping failed");
+    }
+    void *data = MapViewOfFile(handle, writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(handle);
+        return fail(error, "MapViewOfFile failed");
+    }
+    MEMORY_BASIC_INFORMATION info{};
+    VirtualQuery(data, &info, sizeof(info));
+    m_handle = handle;
+    m_size = info.RegionSize;
+#else
+    const int fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        return fail(error, systemError("shm_open"));
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return fail(error, "shared memory object is empty");
+    }
+    void *data = mmap(nullptr, static_cast<size_t>(info.st_size), writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+        MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return fail(error, systemError("mmap"));
+    }
+    m_size = static_cast<size_t>(info.st_size);
+#endif
+
+    m_name = name;
+    m_data = data;
+    m_owner = false;
+    return true;
+}
+
+void SharedMemory::close()
+{
+    if (!m_data) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_handle));
+    m_handle = nullptr;
+#else
+    munmap(m_data, m_size);
+    if (m_owner) {
+        shm_unlink(m_name.c_str());
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_owner = false;
+    m_name.clear();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Named shared memory mapping: POSIX shm_open/mmap, or a pagefile-backed
+// file mapping on Windows.
+class SharedMemory
+{
+public:
+    SharedMemory() = default;
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+
+    bool create(const std::string &name, size_t bytes, std::string *error = nullptr);
+    bool open(const std::string &name, bool writable, std::string *error = nullptr);
+    void close();
+
+    void *data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool isOpen() const { return m_data != nullptr; }
+
+private:
+    std::string m_name;
+    void *m_data = nullptr;
+    size_t m_size = 0;
+    bool m_owner = false;
+#ifdef _WIN32
+    void *m_handle = nullptr;
+#endif
+};
@@ -0,0 +1,165 @@
+#include "signalgenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+constexpr int kMultitoneCount = 31;
+// Raised-cosine fade at each end of a sweep period, as a fraction of it.
+constexpr double kSweepFade = 0.01;
+
+double pi()
+{
+    return std::acos(-1.0);
+}
+} // namespace
+
+void SignalGenerator::configure(int sampleRate)
+{
+    if (sampleRate > 0) {
+        m_sampleRate = sampleRate;
+    }
+    reset();
+}
+
+void SignalGenerator::setType(Type type)
+{
+    m_type = type;
+    reset();
+}
+
+void SignalGenerator::setLevel(float level)
+{
+    m_level = std::max(0.0f, std::min(1.0f, level));
+}
+
+void SignalGenerator::setFrequency(double hz)
+{
+    m_frequency = std::max(1.0, hz);
+}
+
+void SignalGenerator::setSweepRange(double startHz, double endHz)
+{
+    m_sweepStart = std::max(1.0, std::min(startHz, endHz));
+    m_sweepEnd = std::max(m_sweepStart * 1.01, std::max(startHz, endHz));
+    reset();
+}
+
+void SignalGenerator::reset()
+{
+    m_phase = 0.0;
+    m_position = 0;
+    m_table.clear();
+    switch (m_type) {
+    case TypeMultitone:
+        renderMultitone();
+        break;
+    case TypeLogSweep:
+        renderSweep();
+        break;
+    case TypeMls:
+        renderMls();
+        break;
+    case TypeSine:
+    default:
+        break;
+    }
+}
+
+void SignalGenerator::generate(float *out, int frames)
+{
+    if (m_table.empty()) {
+        const double step = 2.0 * pi() * m_frequency / m_sampleRate;
+        for (int i = 0; i < frames; ++i) {
+            out[i] = m_level * static_cast<float>(std::sin(m_phase));
+            m_phase += step;
+        }
+        m_phase = std::fmod(m_phase, 2.0 * pi());
+        return;
+    }
+
+    const int period = static_cast<int>(m_table.size());
+    int written = 0;
+    while (written < frames) {
+        const int take = std::min(frames - written, period - m_position);
+        const float *source = m_table.data() + m_position;
+        for (int i = 0; i < take; ++i) {
+            out[written + i] = m_level * source[i];
+        }
+        written += take;
+        m_position = (m_position + take) % period;
+    }
+}
+
+void SignalGenerator::renderMultitone()
+{
+    const int n = kPeriodFrames;
+    const double binHz = static_cast<double>(m_sampleRate) / n;
+    const double low = 20.0;
+    const double high = 0.45 * m_sampleRate;
+
+    // Log-spaced tones snapped to whole cycles per period, so the table
+    // loops without a discontinuity and every tone lands on one FFT bin.
+    std::vector<int> bins;
+    for (int k = 0; k < kMultitoneCount; ++k) {
+        const double hz = low * std::pow(high / low, static_cast<double>(k) / (kMultitoneCount - 1));
+        const int bin = std::max(1, static_cast<int>(std::lround(hz / binHz)));
+        if (bins.empty() || bin != bins.back()) {
+            bins.push_back(bin);
+        }
+    }
+
+    std::vector<double> sum(n, 0.0);
+    const int count = static_cast<int>(bins.size());
+    for (int k = 0; k < count; ++k) {
+        const double phase = -pi() * k * k / count;
+        const double step = 2.0 * pi() * bins[k] / n;
+        for (int i = 0; i < n; ++i) {
+            sum[i] += std::cos(step * i + phase);
+        }
+    }
+
+    double peak = 0.0;
+    for (double value : sum) {
+        peak = std::max(peak, std::fabs(value));
+    }
+    m_table.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_table[i] = static_cast<float>(sum[i] / std::max(peak, 1e-12));
+    }
+}
+
+void SignalGenerator::renderSweep()
+{
+    const int n = kPeriodFrames;
+    const double seconds = static_cast<double>(n) / m_sampleRate;
+    const double end = std::min(m_sweepEnd, 0.48 * m_sampleRate);
+    const double rate = std::log(end / m_sweepStart);
+    const int fade = static_cast<int>(n * kSweepFade);
+
+    m_table.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i) / m_sampleRate;
+        const double phase = 2.0 * pi() * m_sweepStart * seconds / rate * (std::exp(t / seconds * rate) - 1.0);
+        double gain = 1.0;
+        if (i < fade) {
+            gain = 0.5 - 0.5 * std::cos(pi() * i / fade);
+        } else if (i >= n - fade) {
+            gain = 0.5 - 0.5 * std::cos(pi() * (n - 1 - i) / fade);
+        }
+        m_table[i] = static_cast<float>(gain * std::sin(phase));
+    }
+}
+
+void SignalGenerator::renderMls()
+{
+    // Galois LFSR for x^16 + x^14 + x^13 + x^11 + 1; period 2^16 - 1.
+    const int n = (1 << kMlsOrder) - 1;
+    uint32_t state = 1;
+    m_table.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_table[i] = (state & 1u) ? 1.0f : -1.0f;
+        state = (state >> 1) ^ (-(state & 1u) & 0xB400u);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+// Test signals for the output path. Everything except the sine is
+// periodic: one period is rendered at full scale into a table when the
+// generator is reset, so generate() only scales and copies and never
+// allocates. Changing the level does not restart the period.
+class SignalGenerator
+{
+public:
+    enum Type {
+        TypeSine = 0,
+        TypeMultitone = 1,  // log-spaced tones on exact bins, Schroeder phases
+        TypeLogSweep = 2,   // exponential sine sweep, repeated
+        TypeMls = 3         // maximum length sequence, order 16
+    };
+
+    static constexpr int kPeriodFrames = 65536;
+    static constexpr int kMlsOrder = 16;
+
+    void configure(int sampleRate);
+    void setType(Type type);
+    void setLevel(float level);
+    void setFrequency(double hz);
+    void setSweepRange(double startHz, double endHz);
+    void reset();
+
+    int sampleRate() const { return m_sampleRate; }
+    Type type() const { return m_type; }
+    float level() const { return m_level; }
+    // Samples per period, or 0 for the free-running sine.
+    int periodFrames() const { return static_cast<int>(m_table.size()); }
+
+    void generate(float *out, int frames);
+
+private:
+    void renderMultitone();
+    void renderSweep();
+    void renderMls();
+
+    int m_sampleRate = 48000;
+    Type m_type = TypeSine;
+    float m_level = 0.5f;
+    double m_frequency = 1000.0;
+    double m_sweepStart = 20.0;
+    double m_sweepEnd = 20000.0;
+
+    double m_phase = 0.0;
+    std::vector<float> m_table;
+    int m_position = 0;
+};
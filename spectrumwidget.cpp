@@ -3,8 +3,6 @@
 #include <QPainter>
 
 #include <algorithm>
-#include <cmath>
-#include <complex>
 
 namespace {
 QString formatFrequency(float hz)
@@ -23,11 +21,10 @@ SpectrumWidget::SpectrumWidget(QWidget *parent)
     setAutoFillBackground(false);
 }
 
-void SpectrumWidget::setSamples(const QVector<float> &samples, int sampleRate)
+void SpectrumWidget::setSpectrum(const QVector<float> &bins, int sampleRate)
 {
-    m_samples = samples;
+    m_bins = bins;
     m_sampleRate = sampleRate;
-    computeSpectrum();
     update();
 }
 
@@ -81,70 +78,3 @@ void SpectrumWidget::paintEvent(QPaintEvent *event)
         }
     }
 }
-
-void SpectrumWidget::computeSpectrum()
-{
-    m_bins.clear();
-    if (m_samples.size() < 8) {
-        return;
-    }
-
-    const int n = nextPow2(m_samples.size());
-    if (n < 8) {
-        return;
-    }
-
-    QVector<std::complex<float>> data;
-    data.resize(n);
-
-    for (int i = 0; i < n; ++i) {
-        const float sample = (i < m_samples.size()) ? m_samples[i] : 0.0f;
-        const float pi = std::acos(-1.0f);
-        const float window = 0.5f * (1.0f - std::cos(2.0f * pi * i / (n - 1)));
-        data[i] = std::complex<float>(sample * window, 0.0f);
-    }
-
-    for (int i = 1, j = 0; i < n; ++i) {
-        int bit = n >> 1;
-        for (; j & bit; bit >>= 1) {
-            j ^= bit;
-        }
-        j ^= bit;
-        if (i < j) {
-            std::swap(data[i], data[j]);
-        }
-    }
-
-    for (int len = 2; len <= n; len <<= 1) {
-        const float pi = std::acos(-1.0f);
-        const float angle = -2.0f * pi / static_cast<float>(len);
-        std::complex<float> wlen(std::cos(angle), std::sin(angle));
-        for (int i = 0; i < n; i += len) {
-            std::complex<float> w(1.0f, 0.0f);
-            const int half = len / 2;
-            for (int j = 0; j < half; ++j) {
-                const std::complex<float> u = data[i + j];
-                const std::complex<float> v = data[i + j + half] * w;
-                data[i + j] = u + v;
-                data[i + j + half] = u - v;
-                w *= wlen;
-            }
-        }
-    }
-
-    const int bins = n / 2;
-    m_bins.resize(bins);
-    for (int i = 0; i < bins; ++i) {
-        const float mag = std::abs(data[i]) / static_cast<float>(n);
-        m_bins[i] = mag;
-    }
-}
-
-int SpectrumWidget::nextPow2(int value) const
-{
-    int n = 1;
-    while (n < value) {
-        n <<= 1;
-    }
-    return n;
-}
@@ -11,16 +11,13 @@ public:
     explicit SpectrumWidget(QWidget *parent = nullptr);
 
 public slots:
-    void setSamples(const QVector<float> &samples, int sampleRate);
+    // Shows magnitude bins computed elsewhere, e.g. the graph's shared STFT.
+    void setSpectrum(const QVector<float> &bins, int sampleRate);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
 
 private:
-    void computeSpectrum();
-    int nextPow2(int value) const;
-
-    QVector<float> m_samples;
     QVector<float> m_bins;
     int m_sampleRate = 0;
 };
@@ -0,0 +1,329 @@
+#include "batchanalyzer.h"
+#include "testsupport.h"
+#include "triggerdetector.h"
+#include "wavfile.h"
+#include "workstealingpool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr int kSampleRate = 48000;
+
+fs::path tempDir()
+{
+#ifdef _WIN32
+    const unsigned long pid = GetCurrentProcessId();
+#else
+    const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    return fs::temp_directory_path() / ("scopevibe-batchtest-" + std::to_string(pid));
+}
+
+std::vector<float> tone(double frequency, double amplitude, int frames)
+{
+    const double pi = std::acos(-1.0);
+    std::vector<float> samples(frames);
+    for (int i = 0; i < frames; ++i) {
+        samples[i] = static_cast<float>(amplitude * std::sin(2.0 * pi * frequency * i / kSampleRate));
+    }
+    return samples;
+}
+
+// Silence with 100 ms bursts of a 1 kHz tone, each starting at phase zero,
+// so every burst crosses the trigger levels at known offsets.
+constexpr int kBurstFrames = 4800;
+constexpr int kBurstStarts[] = {1000, 20000};
+
+std::vector<float> gatedTone(int frames)
+{
+    std::vector<float> samples(frames, 0.0f);
+    const std::vector<float> burst = tone(1000.0, 0.8, kBurstFrames);
+    for (int start : kBurstStarts) {
+        std::copy(burst.begin(), burst.end(), samples.begin() + start);
+    }
+    return samples;
+}
+
+std::vector<float> noise(unsigned seed, int frames)
+{
+    std::mt19937 random(seed);
+    std::normal_distribution<float> gauss(0.0f, 0.1f);
+    std::vector<float> samples(frames);
+    for (float &sample : samples) {
+        sample = gauss(random);
+    }
+    return samples;
+}
+
+void append16(std::string &bytes, uint16_t value)
+{
+    bytes += static_cast<char>(value & 0xff);
+    bytes += static_cast<char>(value >> 8);
+}
+
+void append32(std::string &bytes, uint32_t value)
+{
+    append16(bytes, static_cast<uint16_t>(value & 0xffff));
+    append16(bytes, static_cast<uint16_t>(value >> 16));
+}
+
+// A RIFF/WAVE file with one fmt chunk and, if dataBytes is non-negative,
+// a data chunk of that many zero bytes.
+std::string riff(uint16_t channels, uint16_t bits, int dataBytes)
+{
+    std::string body = "WAVEfmt ";
+    append32(body, 16);
+    append16(body, 1);
+    append16(body, channels);
+    append32(body, kSampleRate);
+    append32(body, kSampleRate * channels * bits / 8);
+    append16(body, static_cast<uint16_t>(channels * bits / 8));
+    append16(body, bits);
+    if (dataBytes >= 0) {
+        body += "data";
+        append32(body, static_cast<uint32_t>(dataBytes));
+        body.append(dataBytes, '\0');
+    }
+    std::string bytes = "RIFF";
+    append32(bytes, static_cast<uint32_t>(body.size()));
+    return bytes + body;
+}
+
+bool writeBytes(const fs::path &path, const std::string &bytes)
+{
+    std::ofstream out(path, std::ios::binary);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+std::string readFile(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+struct BadFile {
+    const char *name;
+    std::string bytes;
+};
+
+// Same scheduling as the batch tool: one task per file, largest first.
+std::vector<FileReport> runBatch(const BatchAnalyzer &analyzer, const std::vector<fs::path> &inputs,
+    const fs::path &outputDir, int threads, double *elapsed)
+{
+    fs::create_directories(outputDir);
+    std::vector<size_t> order(inputs.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&inputs](size_t a, size_t b) {
+        return fs::file_size(inputs[a]) > fs::file_size(inputs[b]);
+    });
+
+    std::vector<FileReport> reports(inputs.size());
+    const auto started = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(threads);
+        for (size_t index : order) {
+            pool.submit([&, index]() {
+                const fs::path spectrumPath = outputDir / (inputs[index].stem().string() + ".spectrum.csv");
+                reports[index] = analyzer.analyzeFile(inputs[index].string(), spectrumPath.string());
+            });
+        }
+        pool.wait();
+    }
+    *elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return reports;
+}
+
+bool sameWindow(const MeasurementResult &a, const MeasurementResult &b)
+{
+    return a.valid == b.valid && a.sampleRate == b.sampleRate && a.windowFrames == b.windowFrames
+        && a.fftSize == b.fftSize && a.rms == b.rms && a.peak == b.peak && a.crestFactor == b.crestFactor
+        && a.dcOffset == b.dcOffset && a.frequency == b.frequency && a.thd == b.thd && a.thdN == b.thdN
+        && a.snrDb == b.snrDb;
+}
+
+bool sameTriggers(const std::vector<TriggerEvent> &a, const std::vector<TriggerEvent> &b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const TriggerEvent &x, const TriggerEvent &y) {
+        return x.sampleIndex == y.sampleIndex && x.level == y.level && x.rising == y.rising;
+    });
+}
+
+// Everything but the spectrum path must match bit for bit, and so must the
+// spectrum files themselves.
+bool sameReport(const FileReport &a, const FileReport &b)
+{
+    if (a.path != b.path || a.ok != b.ok || a.error != b.error || a.sampleRate != b.sampleRate
+        || a.frames != b.frames || a.seconds != b.seconds || a.channels.size() != b.channels.size()) {
+        return false;
+    }
+    for (size_t c = 0; c < a.channels.size(); ++c) {
+        const ChannelReport &x = a.channels[c];
+        const ChannelReport &y = b.channels[c];
+        if (x.windows.size() != y.windows.size() || !sameTriggers(x.triggers, y.triggers)
+            || !std::equal(x.windows.begin(), x.windows.end(), y.windows.begin(), sameWindow)) {
+            return false;
+        }
+    }
+    return !a.ok || readFile(a.spectrumPath) == readFile(b.spectrumPath);
+}
+
+void testTriggerDetector(TestReport &report)
+{
+    std::printf("-- trigger on a gated tone\n");
+
+    // 0.8 sin(2 pi n / 48) first reaches the upper bound 0.51 at n = 6 and
+    // falls back to the lower bound 0.49 at n = 19.
+    const std::vector<float> samples = gatedTone(30000);
+    const int cycles = kBurstFrames / 48;
+
+    TriggerDetector both;
+    both.setSlope(TriggerDetector::SlopeBoth);
+    both.reset();
+    std::vector<TriggerEvent> events;
+    // Odd block sizes, so edges land on both sides of block boundaries.
+    for (int start = 0; start < static_cast<int>(samples.size()); start += 333) {
+        const int count = std::min(333, static_cast<int>(samples.size()) - start);
+        both.process(samples.data() + start, count, events);
+    }
+    report.expect(events.size() == static_cast<size_t>(2 * 2 * cycles), "%zu edges on both slopes, expected %d",
+        events.size(), 2 * 2 * cycles);
+    int misplaced = 0;
+    for (size_t i = 0; i < events.size() && i < static_cast<size_t>(2 * 2 * cycles); ++i) {
+        const int burst = static_cast<int>(i / (2 * cycles));
+        const int cycle = static_cast<int>(i % (2 * cycles)) / 2;
+        const bool rising = (i % 2) == 0;
+        const int64_t expected = kBurstStarts[burst] + cycle * 48 + (rising ? 6 : 19);
+        if (events[i].sampleIndex != expected || events[i].rising != rising) {
+            ++misplaced;
+        }
+    }
+    report.expect(misplaced == 0, "%d edges at the wrong sample or with the wrong slope", misplaced);
+
+    TriggerDetector gated;
+    gated.setSlope(TriggerDetector::SlopeRising);
+    gated.setHoldoff(kBurstFrames);
+    gated.reset(100000);
+    events.clear();
+    gated.process(samples.data(), static_cast<int>(samples.size()), events);
+    report.expect(events.size() == 2 && events[0].sampleIndex == 100000 + kBurstStarts[0] + 6
+            && events[1].sampleIndex == 100000 + kBurstStarts[1] + 6 && events[0].rising && events[1].rising,
+        "holdoff over a burst leaves one rising edge per burst, counted from the reset index");
+}
+
+void testBatch(TestReport &report)
+{
+    std::printf("-- batch analysis\n");
+
+    const fs::path dir = tempDir();
+    const fs::path inputDir = dir / "in";
+    fs::create_directories(inputDir);
+
+    std::vector<fs::path> inputs;
+    auto addWav = [&](const std::string &name, const std::vector<std::vector<float>> &channels) {
+        const fs::path path = inputDir / name;
+        std::string error;
+        report.expect(WavFile::save(path.string(), channels, kSampleRate, &error), "write %s %s", name.c_str(),
+            error.c_str());
+        inputs.push_back(path);
+    };
+    addWav("stereo.wav", {tone(1000.0, 0.5, 3 * kSampleRate), tone(3000.0, 0.25, 3 * kSampleRate)});
+    addWav("gated.wav", {gatedTone(kSampleRate)});
+    for (unsigned seed = 1; seed <= 8; ++seed) {
+        addWav("noise" + std::to_string(seed) + ".wav", {noise(seed, kSampleRate * (1 + seed % 3))});
+    }
+
+    const std::vector<BadFile> badFiles = {
+        {"garbage.wav", "this is not a wave file at all"},
+        {"truncated.wav", std::string("RIFF\x24\0\0\0WAV", 11)},
+        {"nodata.wav", riff(1, 16, -1)},
+        {"nochannels.wav", riff(0, 16, 64)},
+        {"12bit.wav", riff(1, 12, 64)},
+    };
+    const size_t firstBad = inputs.size();
+    for (const BadFile &bad : badFiles) {
+        inputs.push_back(inputDir / bad.name);
+        writeBytes(inputs.back(), bad.bytes);
+    }
+
+    const BatchAnalyzer analyzer{BatchOptions()};
+    const int threads = std::max(4, static_cast<int>(std::thread::hardware_concurrency()));
+    double serialSeconds = 0.0;
+    double parallelSeconds = 0.0;
+    const std::vector<FileReport> serial = runBatch(analyzer, inputs, dir / "out1", 1, &serialSeconds);
+    const std::vector<FileReport> parallel = runBatch(analyzer, inputs, dir / "outN", threads, &parallelSeconds);
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const std::string name = inputs[i].filename().string();
+        if (i < firstBad) {
+            report.expect(serial[i].ok, "%s analyzed %s", name.c_str(), serial[i].error.c_str());
+        } else {
+            report.expect(!serial[i].ok && !serial[i].error.empty() && !parallel[i].ok,
+                "%s rejected: %s", name.c_str(), serial[i].error.c_str());
+        }
+        report.expect(sameReport(serial[i], parallel[i]), "%s: 1 and %d threads give the same report", name.c_str(),
+            threads);
+    }
+
+    const FileReport &stereo = serial[0];
+    if (report.expect(stereo.ok && stereo.channels.size() == 2 && stereo.channels[0].windows.size() == 3,
+            "stereo file has two channels of three 1 s windows")) {
+        report.expectNear("left frequency", stereo.channels[0].windows[0].frequency, 1000.0, 1.0);
+        report.expectNear("right frequency", stereo.channels[1].windows[0].frequency, 3000.0, 3.0);
+        report.expectNear("left rms", stereo.channels[0].windows[0].rms, 0.5 / std::sqrt(2.0), 1e-3);
+    }
+
+    // Default options: rising edges only and a 10 ms holdoff, longer than
+    // the gap from one cycle to the next but shorter than a burst.
+    const FileReport &gated = serial[1];
+    if (report.expect(gated.ok && gated.channels.size() == 1 && !gated.channels[0].triggers.empty(),
+            "gated file produced triggers")) {
+        const std::vector<TriggerEvent> &triggers = gated.channels[0].triggers;
+        report.expect(triggers[0].sampleIndex == kBurstStarts[0] + 6 && triggers[0].rising,
+            "first trigger at sample %lld, expected %d", static_cast<long long>(triggers[0].sampleIndex),
+            kBurstStarts[0] + 6);
+        const bool spaced = std::adjacent_find(triggers.begin(), triggers.end(),
+            [](const TriggerEvent &a, const TriggerEvent &b) {
+                return b.sampleIndex - a.sampleIndex <= kSampleRate / 100 || !b.rising;
+            }) == triggers.end();
+        report.expect(spaced, "%zu triggers, all rising and more than 10 ms apart", triggers.size());
+    }
+
+    // Informational only: the files are small, and a single-core runner
+    // cannot show any speed-up.
+    std::printf("1 thread %.3f s, %d threads %.3f s (%.2fx, %u hardware threads)\n", serialSeconds, threads,
+        parallelSeconds, parallelSeconds > 0.0 ? serialSeconds / parallelSeconds : 0.0,
+        std::thread::hardware_concurrency());
+
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+}
+} // namespace
+
+int main()
+{
+    TestReport report;
+    testTriggerDetector(report);
+    testBatch(report);
+    return report.exitCode();
+}
@@ -0,0 +1,205 @@
+#include "capturetracker.h"
+#include "testsupport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+// A simulated capture ring polled with jitter and stalls of up to several
+// buffer lengths. Every frame must be numbered right, read before it is
+// overwritten or reported as dropped, and dated close to when the device
+// captured it.
+struct StressCase {
+    const char *name = "";
+    int sampleRate = 48000;
+    double seconds = 600.0;
+    double pollMs = 16.0;
+    double stallRate = 0.01;   // chance that a poll stalls
+    double driftPpm = 80.0;    // device clock error
+    int granule = 480;         // cursor update granularity in frames
+    unsigned seed = 1;
+    double stampLimitUs = 0.0;
+};
+
+void runCase(TestReport &report, const StressCase &test)
+{
+    std::printf("-- %s\n", test.name);
+
+    // Same geometry as the DirectSound buffer: two seconds, the last
+    // eighth treated as unsafe to read.
+    const int sampleRate = test.sampleRate;
+    const int bufferFrames = sampleRate * 2;
+    const int safetyFrames = bufferFrames / 8;
+    const int64_t intactFrames = bufferFrames - safetyFrames;
+    const double deviceRate = sampleRate * (1.0 + test.driftPpm * 1e-6);
+    const int64_t startNs = 1000000000LL;
+    const int64_t endNs = startNs + static_cast<int64_t>(test.seconds * 1e9);
+
+    // Every ring slot holds the index of the frame last written to it.
+    std::vector<int64_t> ring(bufferFrames, -1);
+    int64_t written = 0;
+    int64_t nextRead = 0;
+    int64_t framesRead = 0;
+    int64_t expectedDropped = 0;
+    int expectedGaps = 0;
+    int stalls = 0;
+    int polls = 0;
+    int numberingErrors = 0;
+    int overlaps = 0;
+    double worstStampUs = 0.0;
+    double stampSumUs = 0.0;
+    int stamped = 0;
+    int64_t previousStampNs = 0;
+    int previousFrames = 0;
+
+    std::mt19937 random(test.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    // Stalls from a dropped frame up to three full buffer laps.
+    const double stallSeconds[] = { 0.1, 0.5, 1.6, 1.9, 2.0, 2.4, 4.1, 6.3 };
+
+    CaptureTracker tracker;
+    tracker.start(sampleRate, bufferFrames, safetyFrames, 0, startNs);
+
+    int64_t nowNs = startNs;
+    while (nowNs < endNs) {
+        double stepMs = test.pollMs * (0.5 + unit(random));
+        if (unit(random) < test.stallRate) {
+            stepMs = 1000.0 * stallSeconds[random() % (sizeof(stallSeconds) / sizeof(stallSeconds[0]))];
+            ++stalls;
+        }
+        nowNs += static_cast<int64_t>(stepMs * 1e6);
+
+        // The device fills the ring continuously, but its cursor only
+        // moves in whole granules.
+        const int64_t produced = static_cast<int64_t>(static_cast<double>(nowNs - startNs) * deviceRate / 1e9);
+        const int64_t visible = produced / test.granule * test.granule;
+        for (int64_t frame = std::max(written, visible - bufferFrames); frame < visible; ++frame) {
+            ring[frame % bufferFrames] = frame;
+        }
+        written = visible;
+
+        int offset = 0;
+        const CaptureBlock block = tracker.poll(static_cast<int>(visible % bufferFrames), nowNs, &offset);
+        ++polls;
+
+        const int64_t lost = std::max<int64_t>(0, visible - nextRead - intactFrames);
+        if (lost > 0) {
+            expectedDropped += lost;
+            ++expectedGaps;
+        }
+        if (block.droppedFrames != lost || block.firstFrame != nextRead + lost
+            || block.firstFrame + block.frames != visible) {
+            if (numberingErrors++ < 10) {
+                std::printf("poll %d: got frames %lld+%d dropping %lld, expected %lld+%lld dropping %lld\n", polls,
+                    static_cast<long long>(block.firstFrame), block.frames,
+                    static_cast<long long>(block.droppedFrames), static_cast<long long>(nextRead + lost),
+                    static_cast<long long>(visible - nextRead - lost), static_cast<long long>(lost));
+            }
+            nextRead = visible;
+            continue;
+        }
+
+        for (int i = 0; i < block.frames; ++i) {
+            const int64_t stored = ring[(offset + i) % bufferFrames];
+            if (stored != block.firstFrame + i) {
+                if (numberingErrors++ < 10) {
+                    std::printf("poll %d: frame %lld read as %lld\n", polls,
+                        static_cast<long long>(block.firstFrame + i), static_cast<long long>(stored));
+                }
+                break;
+            }
+        }
+
+        // No block may start before the previous one ended, even at the
+        // fastest clock the tracker allows for.
+        const double previousNs = previousFrames * 1e9 / sampleRate / (1.0 + CaptureTracker::kMaxDriftPpm * 1e-6);
+        if (polls > 1 && block.timestampNs < previousStampNs + static_cast<int64_t>(previousNs)) {
+            ++overlaps;
+        }
+        previousStampNs = block.timestampNs;
+        previousFrames = block.frames;
+
+        if (block.frames > 0) {
+            const double trueNs = startNs + static_cast<double>(block.firstFrame) * 1e9 / deviceRate;
+            const double errorUs = std::fabs(static_cast<double>(block.timestampNs) - trueNs) / 1000.0;
+            worstStampUs = std::max(worstStampUs, errorUs);
+            stampSumUs += errorUs;
+            ++stamped;
+        }
+        framesRead += block.frames;
+        nextRead = visible;
+    }
+
+    std::printf("%d polls, %d stalls, %lld frames dropped in %d gaps, max backlog %.1f ms\n", polls, stalls,
+        static_cast<long long>(tracker.droppedFrames()), tracker.gapCount(),
+        1000.0 * static_cast<double>(tracker.maxBacklogFrames()) / sampleRate);
+    report.expect(numberingErrors == 0, "%d numbering errors", numberingErrors);
+    report.expect(framesRead + tracker.droppedFrames() == written, "every frame read or reported dropped");
+    report.expect(tracker.droppedFrames() == expectedDropped && tracker.gapCount() == expectedGaps,
+        "%lld frames dropped in %d gaps, expected %lld in %d", static_cast<long long>(tracker.droppedFrames()),
+        tracker.gapCount(), static_cast<long long>(expectedDropped), expectedGaps);
+    report.expect(overlaps == 0, "%d blocks stamped before the previous one ended", overlaps);
+    report.expect(worstStampUs <= test.stampLimitUs, "worst timestamp error %.1f us, limit %.1f us, mean %.1f us",
+        worstStampUs, test.stampLimitUs, (stamped > 0) ? stampSumUs / stamped : 0.0);
+}
+} // namespace
+
+int main()
+{
+    TestReport report;
+
+    // The limits sit at about twice the worst error of these fixed seeds.
+    // Without the cursor history a block could be dated up to a whole
+    // cursor step late, 10 ms at 480 frames.
+    StressCase typical;
+    typical.name = "typical device, 80 ppm fast";
+    typical.stampLimitUs = 2500.0;
+    runCase(report, typical);
+
+    StressCase slow;
+    slow.name = "slow clock, 200 ppm";
+    slow.driftPpm = -200.0;
+    slow.seed = 2;
+    slow.stampLimitUs = 6000.0;
+    runCase(report, slow);
+
+    StressCase fast;
+    fast.name = "44.1 kHz, 200 ppm fast, 10 ms polls";
+    fast.sampleRate = 44100;
+    fast.granule = 441;
+    fast.pollMs = 10.0;
+    fast.driftPpm = 200.0;
+    fast.seed = 3;
+    fast.stampLimitUs = 4500.0;
+    runCase(report, fast);
+
+    StressCase fine;
+    fine.name = "frame-accurate cursor, 80 ppm slow, 4 ms polls";
+    fine.granule = 1;
+    fine.pollMs = 4.0;
+    fine.driftPpm = -80.0;
+    fine.seed = 4;
+    fine.stampLimitUs = 2500.0;
+    runCase(report, fine);
+
+    StressCase stalls;
+    stalls.name = "frequent stalls";
+    stalls.stallRate = 0.05;
+    stalls.driftPpm = 0.0;
+    stalls.seed = 5;
+    stalls.stampLimitUs = 2500.0;
+    runCase(report, stalls);
+
+    StressCase steady;
+    steady.name = "no stalls, 100 ppm fast";
+    steady.stallRate = 0.0;
+    steady.driftPpm = 100.0;
+    steady.seed = 6;
+    steady.stampLimitUs = 2500.0;
+    runCase(report, steady);
+
+    return report.exitCode();
+}
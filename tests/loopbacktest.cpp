@@ -0,0 +1,248 @@
+#include "capturepipeline.h"
+#include "filterchain.h"
+#include "loopbackanalyzer.h"
+#include "signalgenerator.h"
+#include "testsupport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+// One simulated loopback cable: the generator runs through a known delay
+// and response, and the analyzer has to find both.
+struct LoopbackCase {
+    const char *name = "";
+    SignalGenerator::Type signal = SignalGenerator::TypeMls;
+    int sampleRate = 48000;
+    double delayMs = 12.5;
+    double highPass = 0.0;
+    double lowPass = 0.0;
+    float gain = 0.5f;
+    float noise = 0.0f;
+    int block = 1440;
+    // Extra frames the host schedules the emission late, as the playback
+    // lead does on a real device; the result must exclude them.
+    int outputLead = 0;
+    // Filter selected in the scope's pipeline (runPipelineCase only).
+    FilterChain::Preset preset = FilterChain::PresetNone;
+};
+
+LoopbackSimulator makeSimulator(const LoopbackCase &test, int extraDelay)
+{
+    const int delayFrames = static_cast<int>(std::lround(test.delayMs * test.sampleRate / 1000.0));
+    LoopbackSimulator simulator;
+    simulator.configure(test.sampleRate, delayFrames + extraDelay);
+    std::vector<BiquadCoefficients> response;
+    if (test.highPass > 0.0) {
+        response.push_back(BiquadCoefficients::highPass(test.sampleRate, test.highPass));
+    }
+    if (test.lowPass > 0.0) {
+        response.push_back(BiquadCoefficients::lowPass(test.sampleRate, test.lowPass));
+    }
+    simulator.setResponse(response);
+    simulator.setGain(test.gain);
+    simulator.setNoiseLevel(test.noise);
+    return simulator;
+}
+
+// The measured latency and response must be the simulated cable's, with
+// `excluded` frames of host scheduling taken out.
+void checkResult(TestReport &report, const LoopbackCase &test, const LoopbackSimulator &simulator,
+    const LoopbackResult &result, int excluded)
+{
+    if (!report.expect(result.valid, "result valid")) {
+        return;
+    }
+
+    const double expectedLatency = simulator.expectedLatency() - excluded;
+    report.expectNear("latency samples", result.latencySamples, expectedLatency, 1.0);
+    report.expectNear("latency ms", result.latencyMs, 1000.0 * expectedLatency / test.sampleRate,
+        1000.0 / test.sampleRate);
+    // A multitone's phase only pins the delay down modulo its period.
+    if (test.signal != SignalGenerator::TypeMultitone) {
+        report.expectNear("response delay", result.response.delaySamples, result.latencySamples, 1.0);
+    }
+
+    // Compare against the injected response where the measurement is
+    // meaningful: coherent bins away from DC and Nyquist.
+    const TransferResult &measured = result.response;
+    double worstDb = 0.0;
+    int compared = 0;
+    for (double hz = 62.5; hz < 0.4 * test.sampleRate; hz *= 2.0) {
+        const int bin = static_cast<int>(std::lround(hz * measured.fftSize / test.sampleRate));
+        if (bin <= 0 || bin >= static_cast<int>(measured.magnitudeDb.size()) || measured.coherence[bin] <= 0.9f) {
+            continue;
+        }
+        const double binHz = static_cast<double>(bin) * test.sampleRate / measured.fftSize;
+        const double expectedDb = 20.0 * std::log10(std::max(1e-10, simulator.magnitudeAt(binHz)));
+        worstDb = std::max(worstDb, std::fabs(expectedDb - measured.magnitudeDb[bin]));
+        ++compared;
+    }
+    report.expect(compared >= 5, "%d coherent octave bins compared", compared);
+    report.expect(worstDb <= 1.0, "worst response error %.2f dB", worstDb);
+}
+
+// The scope's pipeline plays the generator and hears it back one block
+// later through the simulated cable. Its filters must not show up in the
+// result.
+void runPipelineCase(TestReport &report, const LoopbackCase &test)
+{
+    std::printf("-- %s\n", test.name);
+
+    // Whatever is emitted while block k is processed comes back in the
+    // captured block k+1, so the host schedules it one block late.
+    LoopbackSimulator simulator = makeSimulator(test, 0);
+    std::vector<float> captured(test.block, 0.0f);
+    std::vector<float> returned(test.block, 0.0f);
+    std::vector<float> processed(test.block);
+    bool finished = false;
+    LoopbackResult result;
+
+    int latency = 0;
+    CapturePipeline::Callbacks callbacks;
+    callbacks.output = [&](const GraphBlock &block, const float *samples, bool *resynced) {
+        (void)resynced;
+        simulator.process(samples, returned.data(), block.frames);
+        // Relative to the block's stamp, which the graph dated back by its
+        // latency.
+        return static_cast<double>(test.block + latency);
+    };
+    callbacks.loopbackFinished = [&](const LoopbackResult &measured) {
+        finished = true;
+        result = measured;
+    };
+    CapturePipeline pipeline(callbacks);
+    pipeline.setFilterPreset(test.preset);
+    pipeline.prepare(test.sampleRate, 1);
+    latency = pipeline.graph().latencyFrames();
+    pipeline.generator().setType(test.signal);
+    pipeline.setGeneratorEnabled(true);
+    pipeline.startLoopbackMeasurement();
+    std::printf("processing latency %d frames\n", latency);
+
+    CaptureBlock position;
+    position.frames = test.block;
+    for (int blocks = 0; !finished && blocks < 10000; ++blocks) {
+        position.firstFrame = static_cast<long long>(blocks) * test.block;
+        processed = captured;
+        pipeline.process(position, processed.data(), test.block);
+        captured = returned;
+    }
+    report.expect(finished, "measurement finished");
+    checkResult(report, test, simulator, result, 0);
+}
+
+void runCase(TestReport &report, const LoopbackCase &test)
+{
+    std::printf("-- %s\n", test.name);
+
+    SignalGenerator generator;
+    generator.configure(test.sampleRate);
+    generator.setType(test.signal);
+
+    LoopbackSimulator simulator = makeSimulator(test, test.outputLead);
+
+    LoopbackAnalyzer analyzer;
+    analyzer.configure(test.sampleRate);
+    analyzer.setOutputLead(test.outputLead);
+
+    std::vector<float> emitted(test.block);
+    std::vector<float> captured(test.block);
+    bool finished = false;
+    while (!analyzer.isComplete()) {
+        generator.generate(emitted.data(), test.block);
+        simulator.process(emitted.data(), captured.data(), test.block);
+        finished = analyzer.process(emitted.data(), captured.data(), test.block) || finished;
+    }
+
+    report.expect(finished, "process() reported completion");
+    checkResult(report, test, simulator, analyzer.result(), test.outputLead);
+}
+
+// Moving the level control mid-measurement must only scale the signal;
+// restarting the period would break the correlation the analyzer relies on.
+void testLevelChange(TestReport &report, SignalGenerator::Type type, const char *name)
+{
+    SignalGenerator reference;
+    reference.configure(48000);
+    reference.setType(type);
+    reference.setLevel(1.0f);
+    std::vector<float> expected(3000);
+    reference.generate(expected.data(), static_cast<int>(expected.size()));
+
+    SignalGenerator generator;
+    generator.configure(48000);
+    generator.setType(type);
+    generator.setLevel(0.5f);
+    std::vector<float> actual(expected.size());
+    generator.generate(actual.data(), 1000);
+    generator.setLevel(0.25f);
+    generator.generate(actual.data() + 1000, 2000);
+
+    float worst = 0.0f;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const float level = (i < 1000) ? 0.5f : 0.25f;
+        worst = std::max(worst, std::fabs(actual[i] - level * expected[i]));
+    }
+    report.expect(worst < 1e-6f, "%s: level change keeps the signal running, max error %g", name, worst);
+}
+} // namespace
+
+int main()
+{
+    TestReport report;
+
+    std::printf("-- generator level changes\n");
+    testLevelChange(report, SignalGenerator::TypeSine, "sine");
+    testLevelChange(report, SignalGenerator::TypeMultitone, "multitone");
+    testLevelChange(report, SignalGenerator::TypeLogSweep, "log sweep");
+    testLevelChange(report, SignalGenerator::TypeMls, "mls");
+
+    LoopbackCase mls;
+    mls.name = "mls, flat";
+    runCase(report, mls);
+
+    LoopbackCase sweep;
+    sweep.name = "log sweep, band-pass response";
+    sweep.signal = SignalGenerator::TypeLogSweep;
+    sweep.delayMs = 3.1;
+    sweep.highPass = 100.0;
+    sweep.lowPass = 8000.0;
+    sweep.block = 480;
+    runCase(report, sweep);
+
+    LoopbackCase multitone;
+    multitone.name = "multitone, low-pass with noise at 44.1 kHz";
+    multitone.signal = SignalGenerator::TypeMultitone;
+    multitone.sampleRate = 44100;
+    multitone.delayMs = 40.0;
+    multitone.lowPass = 4000.0;
+    multitone.noise = 0.01f;
+    multitone.block = 441;
+    runCase(report, multitone);
+
+    LoopbackCase lead;
+    lead.name = "mls behind a 40 ms playback lead";
+    lead.delayMs = 7.0;
+    lead.gain = 0.8f;
+    lead.outputLead = 1920;
+    runCase(report, lead);
+
+    // The 1 kHz FIR low-pass delays the scope's stream by tens of
+    // milliseconds and cuts most of the MLS; neither may reach the result.
+    LoopbackCase filtered;
+    filtered.name = "mls through the pipeline with the FIR low-pass selected";
+    filtered.delayMs = 9.0;
+    filtered.highPass = 200.0;
+    filtered.block = 480;
+    filtered.preset = FilterChain::PresetFirLowPass1k;
+    runPipelineCase(report, filtered);
+
+    LoopbackCase unfiltered = filtered;
+    unfiltered.name = "mls through the pipeline, no filter";
+    unfiltered.preset = FilterChain::PresetNone;
+    runPipelineCase(report, unfiltered);
+
+    return report.exitCode();
+}
@@ -0,0 +1,114 @@
+#include "measurementengine.h"
+#include "testsupport.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr int kSampleRate = 48000;
+constexpr int kWindowMs = 500;
+
+struct Tone {
+    double frequency = 1000.0;
+    double amplitude = 0.5;
+    std::vector<double> harmonics;   // amplitudes of harmonics 2, 3, ...
+    double dc = 0.0;
+    double noise = 0.0;              // white noise standard deviation
+};
+
+MeasurementResult measure(const Tone &tone)
+{
+    const double pi = std::acos(-1.0);
+    std::mt19937 random(1);
+    std::normal_distribution<double> gaussian(0.0, 1.0);
+
+    // Exactly one window, so result() describes this signal only.
+    std::vector<float> samples(kSampleRate * kWindowMs / 1000);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const double t = static_cast<double>(i) / kSampleRate;
+        double value = tone.dc + tone.amplitude * std::sin(2.0 * pi * tone.frequency * t);
+        for (size_t h = 0; h < tone.harmonics.size(); ++h) {
+            value += tone.harmonics[h] * std::sin(2.0 * pi * (h + 2) * tone.frequency * t);
+        }
+        value += tone.noise * gaussian(random);
+        samples[i] = static_cast<float>(value);
+    }
+
+    MeasurementEngine engine;
+    engine.setSampleRate(kSampleRate);
+    engine.setWindowMs(kWindowMs);
+    engine.process(samples.data(), static_cast<int>(samples.size()));
+    return engine.result();
+}
+
+double harmonicSum(const Tone &tone)
+{
+    double sum = 0.0;
+    for (double amplitude : tone.harmonics) {
+        sum += amplitude * amplitude;
+    }
+    return sum;
+}
+
+double expectedRms(const Tone &tone)
+{
+    return std::sqrt(tone.dc * tone.dc + 0.5 * tone.amplitude * tone.amplitude + 0.5 * harmonicSum(tone)
+        + tone.noise * tone.noise);
+}
+} // namespace
+
+int main()
+{
+    TestReport report;
+
+    // Pure tones on and between bins: level and frequency.
+    for (double frequency : { 1000.0, 997.3, 62.5, 12345.6 }) {
+        Tone tone;
+        tone.frequency = frequency;
+        const MeasurementResult result = measure(tone);
+        std::printf("-- pure sine %.1f Hz\n", frequency);
+        report.expect(result.valid, "result valid");
+        report.expectNear("rms", result.rms, expectedRms(tone), 2e-4);
+        report.expectNear("peak", result.peak, tone.amplitude, 1e-3);
+        report.expectNear("frequency", result.frequency, frequency, 0.02);
+        report.expect(result.thd < 1e-4, "thd %.2e below 1e-4", result.thd);
+    }
+
+    // Known harmonic distortion plus DC.
+    {
+        Tone tone;
+        tone.frequency = 997.3;
+        tone.harmonics = { 0.005, 0.0025, 0.001 };
+        tone.dc = 0.01;
+        const MeasurementResult result = measure(tone);
+        const double thd = std::sqrt(harmonicSum(tone)) / tone.amplitude;
+        std::printf("-- distorted sine, THD %.4f%%\n", 100.0 * thd);
+        report.expectNear("rms", result.rms, expectedRms(tone), 2e-4);
+        // The window holds a non-integer number of cycles, so the mean
+        // carries up to A / (2 pi f T) of the tone.
+        report.expectNear("dc", result.dcOffset, tone.dc, 5e-4);
+        report.expectNear("frequency", result.frequency, tone.frequency, 0.01);
+        report.expectNear("thd", result.thd, thd, 0.02 * thd);
+        report.expect(result.thdN >= result.thd, "thd+n %.6f not below thd", result.thdN);
+    }
+
+    // Known signal-to-noise ratio with a little distortion.
+    for (double noise : { 0.0005, 0.005 }) {
+        Tone tone;
+        tone.frequency = 1234.5;
+        tone.harmonics = { 0.002 };
+        tone.noise = noise;
+        const MeasurementResult result = measure(tone);
+        const double snrDb = 10.0 * std::log10(0.5 * tone.amplitude * tone.amplitude / (noise * noise));
+        const double thdN = std::sqrt(0.5 * harmonicSum(tone) + noise * noise) / (tone.amplitude / std::sqrt(2.0));
+        std::printf("-- noisy sine, SNR %.1f dB\n", snrDb);
+        report.expectNear("rms", result.rms, expectedRms(tone), 5e-4);
+        report.expectNear("snr dB", result.snrDb, snrDb, 0.5);
+        report.expectNear("thd+n", result.thdN, thdN, 0.05 * thdN);
+        report.expectNear("thd", result.thd, 0.002 / tone.amplitude, 0.1 * 0.002 / tone.amplitude);
+        report.expectNear("frequency", result.frequency, tone.frequency, 0.05);
+    }
+
+    return report.exitCode();
+}
@@ -0,0 +1,179 @@
+#include "octavebandanalyzer.h"
+#include "testsupport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+const double kPi = std::acos(-1.0);
+
+// Feeds a sine in 1000-frame blocks, the way the scope hands over audio.
+void feedTone(OctaveBandAnalyzer &analyzer, double frequency, double amplitude, double seconds, double *phase)
+{
+    const int rate = analyzer.sampleRate();
+    const int frames = static_cast<int>(seconds * rate);
+    std::vector<float> block(1000);
+    for (int start = 0; start < frames; start += static_cast<int>(block.size())) {
+        const int count = std::min(static_cast<int>(block.size()), frames - start);
+        for (int i = 0; i < count; ++i) {
+            block[i] = static_cast<float>(amplitude * std::sin(*phase));
+            *phase += 2.0 * kPi * frequency / rate;
+        }
+        analyzer.process(block.data(), count);
+    }
+    *phase = std::fmod(*phase, 2.0 * kPi);
+}
+
+int bandNear(const OctaveBandAnalyzer &analyzer, double frequency)
+{
+    int best = 0;
+    for (int i = 1; i < analyzer.bandCount(); ++i) {
+        if (std::fabs(std::log(analyzer.centerFrequency(i) / frequency))
+            < std::fabs(std::log(analyzer.centerFrequency(best) / frequency))) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// A half-scale sine on a band centre reads -6.02 dB in that band, and the
+// neighbouring bands are held down by at least `adjacentDb`.
+struct CentreCase {
+    const char *name = "";
+    int sampleRate = 48000;
+    int bandsPerOctave = 3;
+    double frequency = 1000.0;
+    double settleSeconds = 1.0;
+    double measureSeconds = 2.0;
+    double tolerance = 0.1;
+    double adjacentDb = 17.0;
+};
+
+void runCentreCase(TestReport &report, const CentreCase &test)
+{
+    std::printf("-- %s\n", test.name);
+
+    OctaveBandAnalyzer analyzer;
+    analyzer.configure(test.sampleRate, test.bandsPerOctave);
+    double phase = 0.0;
+    feedTone(analyzer, test.frequency, 0.5, test.settleSeconds, &phase);
+    analyzer.resetLeq();
+    feedTone(analyzer, test.frequency, 0.5, test.measureSeconds, &phase);
+
+    std::vector<float> levels;
+    analyzer.levels(OctaveBandAnalyzer::IntegrationLeq, levels);
+    const int band = bandNear(analyzer, test.frequency);
+    report.expectNear("in-band level", levels[band], -6.02, test.tolerance);
+    if (band > 0) {
+        report.expect(levels[band - 1] <= -6.02 - test.adjacentDb, "band below (%.1f Hz) at %.2f dB",
+            analyzer.centerFrequency(band - 1), levels[band - 1]);
+    }
+    if (band + 1 < analyzer.bandCount()) {
+        report.expect(levels[band + 1] <= -6.02 - test.adjacentDb, "band above (%.1f Hz) at %.2f dB",
+            analyzer.centerFrequency(band + 1), levels[band + 1]);
+    }
+}
+
+// Fast and Slow are exponential in power with 125 ms and 1 s time
+// constants: one time constant after a tone starts they are 1 - 1/e of the
+// way up, 1.99 dB short of the final level, and eight Fast time constants
+// into silence they have decayed by 34.74 dB. Leq over a window that is
+// half tone, half silence reads 3.01 dB below the tone.
+void testIntegration(TestReport &report)
+{
+    std::printf("-- integration time constants\n");
+
+    OctaveBandAnalyzer analyzer;
+    analyzer.configure(48000, 3);
+    const int band = bandNear(analyzer, 1000.0);
+    std::vector<float> levels;
+    double phase = 0.0;
+
+    analyzer.resetLeq();
+    feedTone(analyzer, 1000.0, 0.5, 0.125, &phase);
+    analyzer.levels(OctaveBandAnalyzer::IntegrationFast, levels);
+    report.expectNear("Fast after 125 ms", levels[band], -6.02 - 1.99, 0.3);
+
+    feedTone(analyzer, 1000.0, 0.5, 0.875, &phase);
+    analyzer.levels(OctaveBandAnalyzer::IntegrationSlow, levels);
+    report.expectNear("Slow after 1 s", levels[band], -6.02 - 1.99, 0.3);
+    analyzer.levels(OctaveBandAnalyzer::IntegrationFast, levels);
+    report.expectNear("Fast after 1 s", levels[band], -6.02, 0.05);
+
+    feedTone(analyzer, 1000.0, 0.5, 9.0, &phase);
+    analyzer.levels(OctaveBandAnalyzer::IntegrationSlow, levels);
+    report.expectNear("Slow after 10 s", levels[band], -6.02, 0.05);
+
+    analyzer.resetLeq();
+    feedTone(analyzer, 1000.0, 0.5, 1.0, &phase);
+    feedTone(analyzer, 1000.0, 0.0, 1.0, &phase);
+    analyzer.levels(OctaveBandAnalyzer::IntegrationLeq, levels);
+    report.expectNear("Leq over 1 s on, 1 s off", levels[band], -6.02 - 3.01, 0.05);
+    analyzer.levels(OctaveBandAnalyzer::IntegrationFast, levels);
+    report.expectNear("Fast 1 s into silence", levels[band], -6.02 - 34.74, 0.3);
+}
+
+// The whole 1/3-octave bank on 192 kHz audio must keep well ahead of real
+// time.
+void testThroughput(TestReport &report)
+{
+    std::printf("-- throughput\n");
+
+    const int rate = 192000;
+    const double seconds = 5.0;
+    OctaveBandAnalyzer analyzer;
+    analyzer.configure(rate, 3);
+    const auto started = std::chrono::steady_clock::now();
+    double phase = 0.0;
+    feedTone(analyzer, 1000.0, 0.5, seconds, &phase);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    report.expect(elapsed < seconds / 4.0, "%.1f s of %d Hz audio through %d bands in %.3f s", seconds, rate,
+        analyzer.bandCount(), elapsed);
+}
+} // namespace
+
+int main()
+{
+    TestReport report;
+
+    CentreCase third;
+    third.name = "1 kHz, 1/3 octave";
+    runCentreCase(report, third);
+
+    CentreCase octave;
+    octave.name = "1 kHz, 1/1 octave";
+    octave.bandsPerOctave = 1;
+    runCentreCase(report, octave);
+
+    CentreCase twelfth;
+    twelfth.name = "1 kHz, 1/12 octave";
+    twelfth.bandsPerOctave = 12;
+    runCentreCase(report, twelfth);
+
+    // 31.25 Hz is five octaves down: the band runs after several
+    // decimation stages, more of them at the higher rate.
+    CentreCase low;
+    low.name = "31.25 Hz, 1/3 octave at 48 kHz";
+    low.frequency = 1000.0 / 32.0;
+    low.settleSeconds = 2.0;
+    low.measureSeconds = 8.0;
+    low.tolerance = 0.2;
+    runCentreCase(report, low);
+
+    CentreCase lowFast = low;
+    lowFast.name = "31.25 Hz, 1/3 octave at 192 kHz";
+    lowFast.sampleRate = 192000;
+    runCentreCase(report, lowFast);
+
+    CentreCase high;
+    high.name = "16 kHz, 1/3 octave at 48 kHz";
+    high.frequency = 16000.0;
+    runCentreCase(report, high);
+
+    testIntegration(report);
+    testThroughput(report);
+    return report.exitCode();
+}
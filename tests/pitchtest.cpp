@@ -0,0 +1,216 @@
+#include "constantqtransform.h"
+#include "pitchtracker.h"
+#include "testsupport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr int kSampleRate = 48000;
+const double kPi = std::acos(-1.0);
+
+std::vector<float> sine(double frequency, double amplitude, int frames)
+{
+    std::vector<float> samples(frames);
+    for (int i = 0; i < frames; ++i) {
+        samples[i] = static_cast<float>(amplitude * std::sin(2.0 * kPi * frequency * i / kSampleRate));
+    }
+    return samples;
+}
+
+// First 30 harmonics, kept below Nyquist so aliases do not pull the
+// estimate.
+std::vector<float> sawtooth(double frequency, double amplitude, int frames)
+{
+    std::vector<float> samples(frames, 0.0f);
+    const int harmonics = std::min(30, static_cast<int>(0.45 * kSampleRate / frequency));
+    for (int i = 0; i < frames; ++i) {
+        double value = 0.0;
+        for (int h = 1; h <= harmonics; ++h) {
+            value += std::sin(2.0 * kPi * h * frequency * i / kSampleRate) / h;
+        }
+        samples[i] = static_cast<float>(amplitude * 2.0 / kPi * value);
+    }
+    return samples;
+}
+
+double dB(double ratio)
+{
+    return 20.0 * std::log10(std::max(ratio, 1e-12));
+}
+
+// A sine on a bin reads its amplitude there. At 24 bins per octave the
+// bins sit one Hann main-lobe half-width apart, so the neighbours read
+// -6 dB and the bins two away land near the window's first null.
+struct BinCase {
+    const char *name = "";
+    int bin = 0;
+    bool rollOff = true;
+};
+
+void runBinCase(TestReport &report, ConstantQTransform &cqt, const BinCase &test)
+{
+    std::printf("-- %s\n", test.name);
+
+    cqt.reset();
+    const double frequency = cqt.frequency(test.bin);
+    const std::vector<float> samples = sine(frequency, 0.5, cqt.fftSize());
+    cqt.process(samples.data(), static_cast<int>(samples.size()));
+    const std::vector<float> &magnitudes = cqt.magnitudes();
+
+    report.expectNear("on-bin amplitude", magnitudes[test.bin], 0.5, 0.005);
+    if (!test.rollOff) {
+        return;
+    }
+    for (int offset : {-1, 1}) {
+        const int bin = test.bin + offset;
+        if (bin >= 0 && bin < cqt.binCount()) {
+            report.expectNear(offset < 0 ? "bin below dB" : "bin above dB", dB(magnitudes[bin] / 0.5), -6.0, 0.5);
+        }
+    }
+    for (int offset : {-2, 2}) {
+        const int bin = test.bin + offset;
+        if (bin >= 0 && bin < cqt.binCount()) {
+            report.expect(dB(magnitudes[bin] / 0.5) < -25.0, "bin %+d at %.1f dB", offset, dB(magnitudes[bin] / 0.5));
+        }
+    }
+}
+
+// The hop is a whole FFT, so the one frame is taken once the history holds
+// nothing but the sine; the kernels are what is under test, and building
+// them for the full 64k FFT is slow in unoptimised builds.
+void testConstantQ(TestReport &report)
+{
+    ConstantQTransform cqt;
+    cqt.configure(kSampleRate, 110.0, 24, 16384);
+    report.expect(cqt.binCount() > 100 && cqt.fftSize() == 16384, "%d bins from %.2f Hz in a %d-point FFT",
+        cqt.binCount(), cqt.frequency(0), cqt.fftSize());
+
+    BinCase lowest;
+    lowest.name = "lowest bin";
+    runBinCase(report, cqt, lowest);
+
+    BinCase middle;
+    middle.name = "bin 120";
+    middle.bin = 120;
+    runBinCase(report, cqt, middle);
+
+    BinCase highest;
+    highest.name = "highest bin";
+    highest.bin = cqt.binCount() - 1;
+    runBinCase(report, cqt, highest);
+
+    // At 3 bins per octave Q is 3.85, so a 1 Hz kernel would need 185000
+    // samples; the lowest bin is raised to Q * rate / kMaxFftSize.
+    std::printf("-- lowest bin clamp\n");
+    const double q = 1.0 / (std::pow(2.0, 1.0 / 3.0) - 1.0);
+    cqt.configure(kSampleRate, 1.0, 3, ConstantQTransform::kMaxFftSize);
+    report.expectNear("clamped lowest bin Hz", cqt.frequency(0), q * kSampleRate / ConstantQTransform::kMaxFftSize,
+        1e-9);
+    report.expect(cqt.fftSize() == ConstantQTransform::kMaxFftSize, "FFT size %d", cqt.fftSize());
+    BinCase clamped;
+    clamped.name = "clamped lowest bin";
+    clamped.rollOff = false;
+    runBinCase(report, cqt, clamped);
+}
+
+// Every estimate after the first full frame (window plus longest lag at the
+// default 40 Hz floor) must be voiced and within the tolerance.
+struct PitchCase {
+    const char *name = "";
+    double frequency = 440.0;
+    double toleranceCents = 1.0;
+};
+
+void runPitchCase(TestReport &report, PitchTracker &tracker, const PitchCase &test)
+{
+    tracker.reset();
+    const std::vector<float> samples = sawtooth(test.frequency, 0.5, kSampleRate / 2);
+    std::vector<PitchEstimate> estimates;
+    tracker.process(samples.data(), static_cast<int>(samples.size()), estimates);
+
+    std::vector<double> cents;
+    int unvoiced = 0;
+    const int settled = 2 * kSampleRate / 40 + 1;
+    for (const PitchEstimate &estimate : estimates) {
+        if (estimate.sampleIndex < settled) {
+            continue;
+        }
+        if (!estimate.voiced) {
+            ++unvoiced;
+            continue;
+        }
+        cents.push_back(1200.0 * std::log2(estimate.frequency / test.frequency));
+    }
+    if (!report.expect(!cents.empty() && unvoiced == 0, "%s: %zu voiced, %d unvoiced", test.name, cents.size(),
+            unvoiced)) {
+        return;
+    }
+    double worst = 0.0;
+    for (double value : cents) {
+        worst = std::max(worst, std::fabs(value));
+    }
+    report.expect(worst <= test.toleranceCents, "%s: worst error %.2f cents, limit %.1f", test.name, worst,
+        test.toleranceCents);
+}
+
+void testPitch(TestReport &report)
+{
+    std::printf("-- YIN on sawtooths\n");
+
+    PitchTracker tracker;
+    tracker.configure(kSampleRate);
+
+    PitchCase low;
+    low.name = "41.2 Hz";
+    low.frequency = 41.2;
+    runPitchCase(report, tracker, low);
+
+    for (double frequency : {55.0, 110.0, 220.0, 440.0, 880.0}) {
+        PitchCase mid;
+        char name[32];
+        std::snprintf(name, sizeof(name), "%.0f Hz", frequency);
+        mid.name = name;
+        mid.frequency = frequency;
+        runPitchCase(report, tracker, mid);
+    }
+
+    PitchCase high;
+    high.name = "1.5 kHz";
+    high.frequency = 1500.0;
+    runPitchCase(report, tracker, high);
+
+    // The period is only 25 samples here, so the parabolic refinement of
+    // the dip leaves a few cents.
+    PitchCase top;
+    top.name = "1.9 kHz";
+    top.frequency = 1900.0;
+    top.toleranceCents = 5.0;
+    runPitchCase(report, tracker, top);
+
+    std::printf("-- white noise\n");
+    std::mt19937 random(7);
+    std::normal_distribution<float> gauss(0.0f, 0.2f);
+    std::vector<float> noise(4 * kSampleRate);
+    for (float &sample : noise) {
+        sample = gauss(random);
+    }
+    tracker.reset();
+    std::vector<PitchEstimate> estimates;
+    tracker.process(noise.data(), static_cast<int>(noise.size()), estimates);
+    const long voiced = std::count_if(estimates.begin(), estimates.end(), [](const PitchEstimate &estimate) {
+        return estimate.voiced;
+    });
+    report.expect(!estimates.empty() && voiced == 0, "%ld of %zu noise frames voiced", voiced, estimates.size());
+}
+} // namespace
+
+int main()
+{
+    TestReport report;
+    testConstantQ(report);
+    testPitch(report);
+    return report.exitCode();
+}
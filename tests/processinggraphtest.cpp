@@ -0,0 +1,242 @@
+#include "filterchain.h"
+#include "processinggraph.h"
+#include "testsupport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr int kSampleRate = 48000;
+constexpr long long kStartNs = 5000000000LL;
+
+// A unit impulse at tap 0 delays by exactly the processing latency.
+std::vector<float> delayKernel(int taps)
+{
+    std::vector<float> kernel(taps, 0.0f);
+    kernel[0] = 1.0f;
+    return kernel;
+}
+
+// Frame index at which the impulse comes out of a bare FIR stage, fed in
+// uneven blocks.
+int measuredDelay(int taps, int impulseAt)
+{
+    FirFilter filter(delayKernel(taps));
+    filter.prepare(1);
+    std::vector<float> samples(impulseAt + 8192, 0.0f);
+    samples[impulseAt] = 1.0f;
+    const int total = static_cast<int>(samples.size());
+    for (int offset = 0; offset < total; offset += 333) {
+        filter.process(samples.data() + offset, std::min(333, total - offset));
+    }
+    for (int i = 0; i < total; ++i) {
+        if (samples[i] > 0.5f) {
+            return i - impulseAt;
+        }
+    }
+    return -1;
+}
+
+// Largest difference between a long FIR's output, shifted back by
+// latency(), and a direct convolution of the same random input. Blocks are
+// random, or with `straddle` sized around the partition length so they end
+// just before, on and just after partition boundaries.
+double convolutionError(int taps, int channels, bool straddle, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<float> kernel(taps);
+    const float scale = 1.0f / std::sqrt(static_cast<float>(taps));
+    for (float &tap : kernel) {
+        tap = unit(random) * scale;
+    }
+
+    FirFilter filter(kernel);
+    filter.prepare(channels);
+    const int partition = filter.latency();
+    const int frames = taps + 4 * std::max(partition, 1024);
+    std::vector<float> input(static_cast<size_t>(frames) * channels);
+    for (float &sample : input) {
+        sample = unit(random);
+    }
+
+    std::vector<float> output = input;
+    const int pattern[] = {partition - 1, 2, partition, partition + 1, 1, 2 * partition - 1, 3};
+    std::uniform_int_distribution<int> blockSize(1, 3000);
+    for (int offset = 0, step = 0; offset < frames; ++step) {
+        const int block = std::min(frames - offset, straddle ? std::max(1, pattern[step % 7]) : blockSize(random));
+        filter.process(output.data() + static_cast<size_t>(offset) * channels, block);
+        offset += block;
+    }
+
+    // Every output frame of the last partitions, and a sparse sample
+    // before them.
+    double worst = 0.0;
+    const int dense = frames - 2 * std::max(partition, 1024);
+    for (int frame = partition; frame < frames; frame += (frame < dense) ? 97 : 1) {
+        const int source = frame - partition;
+        for (int c = 0; c < channels; ++c) {
+            double expected = 0.0;
+            for (int k = 0; k < taps && k <= source; ++k) {
+                expected += static_cast<double>(kernel[k]) * input[static_cast<size_t>(source - k) * channels + c];
+            }
+            worst = std::max(worst, std::fabs(output[static_cast<size_t>(frame) * channels + c] - expected));
+        }
+    }
+    return worst;
+}
+
+// Steady-state gain of a preset, from a sine through FilterChain::process
+// measured over whole periods once the filter has settled.
+double presetGainDb(FilterChain::Preset preset, double frequency)
+{
+    FilterChain chain;
+    chain.setPreset(preset, kSampleRate);
+    const double pi = std::acos(-1.0);
+    const int settle = kSampleRate;
+    const int periods = static_cast<int>(frequency);
+    const int measure = static_cast<int>(std::lround(periods * kSampleRate / frequency));
+    std::vector<float> samples(settle + measure);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<float>(0.5 * std::sin(2.0 * pi * frequency * static_cast<double>(i) / kSampleRate));
+    }
+    const int total = static_cast<int>(samples.size());
+    for (int offset = 0; offset < total; offset += 480) {
+        chain.process(samples.data() + offset, std::min(480, total - offset), 1);
+    }
+    double power = 0.0;
+    for (int i = settle; i < total; ++i) {
+        power += static_cast<double>(samples[i]) * samples[i];
+    }
+    const double amplitude = std::sqrt(2.0 * power / measure);
+    return 20.0 * std::log10(std::max(amplitude / 0.5, 1e-12));
+}
+
+struct PresetPoint {
+    FilterChain::Preset preset;
+    const char *name;
+    double frequency;
+    double minDb;
+    double maxDb;
+};
+
+struct Hit {
+    long long frame = -1;
+    long long timestampNs = 0;
+};
+
+// Runs an impulse at capture frame impulseFrame through the graph and
+// returns where the branches place it on the capture timeline.
+Hit graphPosition(FilterChain &chain, long long impulseFrame)
+{
+    ProcessingGraph graph;
+    graph.addProcessor(std::make_unique<FilterChainProcessor>(chain));
+    Hit hit;
+    graph.addSink(std::make_unique<CallbackSink>("probe", [&hit](const GraphBlock &block) {
+        for (int i = 0; i < block.frames; ++i) {
+            if (hit.frame < 0 && block.interleaved[i * block.channels] > 0.5f) {
+                hit.frame = block.firstFrame + i;
+                hit.timestampNs = block.timestampNs + static_cast<long long>(i) * 1000000000LL / block.sampleRate;
+            }
+        }
+    }));
+    graph.configure(kSampleRate, 2, 512);
+
+    const int blockFrames = 480;
+    std::vector<float> block(static_cast<size_t>(blockFrames) * 2);
+    for (long long first = 0; first < impulseFrame + 8192; first += blockFrames) {
+        std::fill(block.begin(), block.end(), 0.0f);
+        if (impulseFrame >= first && impulseFrame < first + blockFrames) {
+            block[static_cast<size_t>(impulseFrame - first) * 2] = 1.0f;
+        }
+        graph.setPosition(first, kStartNs + first * 1000000000LL / kSampleRate, false);
+        graph.process(block.data(), blockFrames);
+    }
+    return hit;
+}
+} // namespace
+
+int main()
+{
+    TestReport report;
+
+    // Reported latency matches the delay the convolution actually adds,
+    // both for the direct form and for growing partition sizes.
+    for (int taps : { 32, 65, 300, 2401, 9000 }) {
+        FirFilter filter(delayKernel(taps));
+        report.expect(measuredDelay(taps, 1000) == filter.latency(), "fir %d taps: delay %d, reported %d", taps,
+            measuredDelay(taps, 1000), filter.latency());
+    }
+
+    // The graph moves block positions back by the chain's latency, so the
+    // branches see the impulse where it was captured.
+    const long long impulseFrame = 10007;
+    const long long impulseNs = kStartNs + impulseFrame * 1000000000LL / kSampleRate;
+    for (int taps : { 0, 2401, 9000 }) {
+        FilterChain chain;
+        if (taps > 0) {
+            chain.addFir(delayKernel(taps));
+            chain.addBiquads({ BiquadCoefficients() });
+        }
+        const Hit hit = graphPosition(chain, impulseFrame);
+        std::printf("-- chain with %d fir taps, latency %d\n", taps, chain.latencyFrames());
+        report.expect(hit.frame == impulseFrame, "impulse at frame %lld, captured at %lld", hit.frame, impulseFrame);
+        report.expect(std::llabs(hit.timestampNs - impulseNs) <= 1000, "impulse stamped %lld ns off",
+            hit.timestampNs - impulseNs);
+    }
+
+    // Partitioned convolution against the direct sum, for kernels spanning
+    // from a few partitions to the full sixteen, odd channel counts
+    // included.
+    std::printf("-- long kernels against direct convolution\n");
+    unsigned seed = 1;
+    for (int taps : { 300, 1000, 4097, 20000 }) {
+        for (int channels : { 1, 2, 3 }) {
+            for (bool straddle : { false, true }) {
+                const double error = convolutionError(taps, channels, straddle, seed++);
+                report.expect(error < 1e-4, "fir %d taps, %d channels, %s blocks: max error %.2e", taps, channels,
+                    straddle ? "straddling" : "random", error);
+            }
+        }
+    }
+
+    // Biquad presets at their corners and away from them (the 4th-order
+    // Butterworth is 24.1 dB down an octave out), notches at least 30 dB
+    // deep on the fundamental and third harmonic, and the weightings within
+    // 0.1 dB of IEC 61672-1 up to 10 kHz and 0.2 dB at 16 kHz. The table
+    // rounds A at 31.5 Hz to -39.4; the range is centred on the exact
+    // -39.53.
+    std::printf("-- preset responses\n");
+    const PresetPoint points[] = {
+        { FilterChain::PresetHighPass20, "high-pass 20 Hz", 20.0, -3.06, -2.96 },
+        { FilterChain::PresetHighPass20, "high-pass 20 Hz", 10.0, -24.3, -23.9 },
+        { FilterChain::PresetHighPass20, "high-pass 20 Hz", 1000.0, -0.01, 0.01 },
+        { FilterChain::PresetLowPass20k, "low-pass 20 kHz", 20000.0, -3.06, -2.96 },
+        { FilterChain::PresetLowPass20k, "low-pass 20 kHz", 1000.0, -0.01, 0.01 },
+        { FilterChain::PresetNotch50, "notch 50 Hz", 50.0, -200.0, -30.0 },
+        { FilterChain::PresetNotch50, "notch 50 Hz", 150.0, -200.0, -30.0 },
+        { FilterChain::PresetNotch50, "notch 50 Hz", 1000.0, -0.05, 0.05 },
+        { FilterChain::PresetNotch60, "notch 60 Hz", 60.0, -200.0, -30.0 },
+        { FilterChain::PresetNotch60, "notch 60 Hz", 180.0, -200.0, -30.0 },
+        { FilterChain::PresetNotch60, "notch 60 Hz", 1000.0, -0.05, 0.05 },
+        { FilterChain::PresetAWeighting, "A-weighting", 31.5, -39.63, -39.43 },
+        { FilterChain::PresetAWeighting, "A-weighting", 1000.0, -0.01, 0.01 },
+        { FilterChain::PresetAWeighting, "A-weighting", 10000.0, -2.6, -2.4 },
+        { FilterChain::PresetAWeighting, "A-weighting", 16000.0, -6.8, -6.4 },
+        { FilterChain::PresetCWeighting, "C-weighting", 31.5, -3.1, -2.9 },
+        { FilterChain::PresetCWeighting, "C-weighting", 1000.0, -0.01, 0.01 },
+        { FilterChain::PresetCWeighting, "C-weighting", 10000.0, -4.5, -4.3 },
+        { FilterChain::PresetCWeighting, "C-weighting", 16000.0, -8.7, -8.3 },
+    };
+    for (const PresetPoint &point : points) {
+        const double gain = presetGainDb(point.preset, point.frequency);
+        report.expect(gain >= point.minDb && gain <= point.maxDb, "%s at %g Hz: %.2f dB, expected %.2f to %.2f",
+            point.name, point.frequency, gain, point.minDb, point.maxDb);
+    }
+
+    return report.exitCode();
+}
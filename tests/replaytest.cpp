@@ -0,0 +1,510 @@
+#include "capturepipeline.h"
+#include "capturesession.h"
+#include "pluginloader.h"
+#include "testsupport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr int kSampleRate = 48000;
+constexpr int kChannels = 2;
+
+void printUsage(const char *program)
+{
+    std::fprintf(stderr,
+        "Usage: %s [options] [session]\n"
+        "\n"
+        "Without a session, replays synthetic sessions and checks that every\n"
+        "output of the scope's pipeline is deterministic and correct. With one,\n"
+        "feeds the recorded capture through the same pipeline, prints per-node\n"
+        "timings and digests of every output stream, and optionally checks them\n"
+        "against a golden file. Digests are bit exact, so goldens are only\n"
+        "comparable between builds with the same compiler and flags.\n"
+        "\n"
+        "  --realtime         keep the recorded poll timing (default: flat out)\n"
+        "  --filter N         filter preset index as in the scope (default 0)\n"
+        "  --mix M            left, right or average (default average)\n"
+        "  --plugin FILE      run a block-processor plugin after the filters\n"
+        "  --golden FILE      fail unless the digests match FILE\n"
+        "  --write-golden F   write the digests to F\n",
+        program);
+}
+
+std::string tempPath(const std::string &name)
+{
+#ifdef _WIN32
+    const unsigned long pid = GetCurrentProcessId();
+#else
+    const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    return (fs::temp_directory_path() / ("scopevibe-replaytest-" + std::to_string(pid) + "-" + name)).string();
+}
+
+// Running FNV-1a hash over the exact bits one output stream produced.
+struct StreamDigest {
+    uint64_t hash = 14695981039346656037ULL;
+    long long values = 0;
+
+    void add(const void *data, size_t bytes)
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash = (hash ^ p[i]) * 1099511628211ULL;
+        }
+    }
+
+    void addFloats(const float *data, size_t count)
+    {
+        add(data, count * sizeof(float));
+        values += static_cast<long long>(count);
+    }
+
+    std::string line(const char *name) const
+    {
+        char text[96];
+        std::snprintf(text, sizeof(text), "%s %lld %016llx", name, values, static_cast<unsigned long long>(hash));
+        return text;
+    }
+};
+
+struct ReplayOptions {
+    FilterChain::Preset filter = FilterChain::PresetNone;
+    ProcessingGraph::MonoMix mix = ProcessingGraph::MixAverage;
+    std::string pluginPath;
+    bool realTime = false;
+    // Plays the MLS generator and measures the loopback, with the output
+    // scheduled this many frames after each captured block.
+    bool measureLoopback = false;
+    double outputLead = 0.0;
+};
+
+struct ReplayRun {
+    int channels = 0;
+    int sampleRate = 0;
+    long long blocks = 0;
+    long long frames = 0;
+    long long dropped = 0;
+    int gaps = 0;
+    double elapsedMs = 0.0;
+    double worstLoad = 0.0;
+    int overBudget = 0;
+    std::vector<NodeTiming> timings;
+    std::vector<std::string> digests;
+    std::string recordPath;
+    bool loopbackFinished = false;
+    LoopbackResult loopback;
+};
+
+const char *mixName(ProcessingGraph::MonoMix mix)
+{
+    switch (mix) {
+    case ProcessingGraph::MixLeft:
+        return "left";
+    case ProcessingGraph::MixRight:
+        return "right";
+    default:
+        return "average";
+    }
+}
+
+// Feeds a session through the scope's pipeline with digesting stand-ins for
+// the front end. The processed stream is recorded to run.recordPath, which
+// the caller removes.
+bool replaySession(const std::string &path, const ReplayOptions &options, ReplayRun &run, std::string *error)
+{
+    CaptureSessionReader session;
+    if (!session.open(path, error)) {
+        return false;
+    }
+    run.channels = session.channels();
+    run.sampleRate = session.sampleRate();
+
+    StreamDigest positions;
+    StreamDigest input;
+    StreamDigest scope;
+    StreamDigest output;
+    StreamDigest analysis;
+    StreamDigest spectrum;
+    CapturePipeline::Callbacks callbacks;
+    callbacks.scope = [&scope](const GraphBlock &block) {
+        scope.addFloats(block.mono, static_cast<size_t>(block.frames));
+    };
+    // Plays without ever moving the write position, at a fixed lead.
+    callbacks.output = [&output, &options](const GraphBlock &block, const float *samples, bool *resynced) {
+        (void)resynced;
+        output.addFloats(samples, static_cast<size_t>(block.frames));
+        return options.outputLead;
+    };
+    callbacks.analysis = [&positions, &analysis](const GraphBlock &block) {
+        positions.add(&block.firstFrame, sizeof(block.firstFrame));
+        positions.add(&block.timestampNs, sizeof(block.timestampNs));
+        positions.add(&block.discontinuity, sizeof(block.discontinuity));
+        ++positions.values;
+        analysis.addFloats(block.interleaved, static_cast<size_t>(block.frames) * block.channels);
+    };
+    callbacks.spectrum = [&spectrum](const GraphBlock &block) {
+        spectrum.addFloats(block.spectrum, static_cast<size_t>(block.spectrumBins));
+    };
+    callbacks.loopbackFinished = [&run](const LoopbackResult &result) {
+        run.loopbackFinished = true;
+        run.loopback = result;
+    };
+
+    CapturePipeline pipeline(callbacks);
+    pipeline.setFilterPreset(options.filter);
+    pipeline.setMonoMix(options.mix);
+    std::string pluginName = "none";
+    if (!options.pluginPath.empty()) {
+        std::unique_ptr<BlockProcessor> plugin = loadPlugin(options.pluginPath, error);
+        if (!plugin) {
+            return false;
+        }
+        pluginName = plugin->name();
+        pipeline.addPlugin(std::move(plugin));
+    }
+    pipeline.prepare(run.sampleRate, run.channels);
+    if (!pipeline.startRecording(run.recordPath, error)) {
+        return false;
+    }
+    if (options.measureLoopback) {
+        pipeline.generator().setType(SignalGenerator::TypeMls);
+        pipeline.setGeneratorEnabled(true);
+        pipeline.startLoopbackMeasurement();
+    }
+
+    using Clock = std::chrono::steady_clock;
+    CaptureSessionBlock block;
+    std::vector<float> interleaved;
+    int64_t previousPollNs = 0;
+    double previousWorkNs = 0.0;
+    const Clock::time_point started = Clock::now();
+    while (session.next(block)) {
+        if (options.realTime) {
+            std::this_thread::sleep_until(started + std::chrono::nanoseconds(block.pollNs));
+        }
+
+        // Work per poll against the time the device gave until the next
+        // one: above 1 the live scope would have fallen behind.
+        if (run.blocks > 0 && block.pollNs > previousPollNs) {
+            const double load = previousWorkNs / static_cast<double>(block.pollNs - previousPollNs);
+            run.worstLoad = std::max(run.worstLoad, load);
+            run.overBudget += (load > 1.0) ? 1 : 0;
+        }
+
+        const Clock::time_point workStart = Clock::now();
+        const CaptureBlock &position = block.position;
+        interleaved.resize(block.pcm.size());
+        decodePcm16(block.pcm.data(), static_cast<int>(block.pcm.size()), interleaved.data());
+        input.addFloats(interleaved.data(), interleaved.size());
+        if (position.frames > 0) {
+            pipeline.process(position, interleaved.data(), position.frames);
+        }
+        previousWorkNs = std::chrono::duration<double, std::nano>(Clock::now() - workStart).count();
+        previousPollNs = block.pollNs;
+
+        ++run.blocks;
+        run.frames += position.frames;
+        run.dropped += position.droppedFrames;
+        run.gaps += (position.droppedFrames > 0) ? 1 : 0;
+    }
+    run.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+    run.timings = pipeline.graph().timings();
+    pipeline.stopRecording();
+
+    StreamDigest recorder;
+    std::ifstream recorded(run.recordPath, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(recorded)), std::istreambuf_iterator<char>());
+    recorder.add(bytes.data(), bytes.size());
+    recorder.values = static_cast<long long>(bytes.size());
+
+    char settings[160];
+    std::snprintf(settings, sizeof(settings), "settings filter=%d mix=%s plugin=%s channels=%d rate=%d",
+        static_cast<int>(options.filter), mixName(options.mix), pluginName.c_str(), run.channels, run.sampleRate);
+    run.digests = {
+        "scopevibe-replay 2",
+        settings,
+        positions.line("positions"),
+        input.line("input"),
+        scope.line("scope"),
+        output.line("output"),
+        analysis.line("analysis"),
+        spectrum.line("spectrum"),
+        recorder.line("recorder"),
+    };
+    return true;
+}
+
+// Jittered poll sizes around 30 ms and one gap, as a live capture
+// records them. `sample` gives the int16 value of every frame and channel.
+template <typename Sample>
+bool writeSession(const std::string &path, double seconds, bool withGap, Sample sample, std::string *error)
+{
+    CaptureSessionWriter writer;
+    if (!writer.open(path, kChannels, kSampleRate, error)) {
+        return false;
+    }
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> jitter(0.5, 1.5);
+    const long long total = static_cast<long long>(seconds * kSampleRate);
+    long long frame = 0;
+    int64_t pollNs = 0;
+    std::vector<int16_t> pcm;
+    while (frame < total) {
+        const int64_t stepNs = static_cast<int64_t>(30e6 * jitter(random));
+        CaptureBlock block;
+        block.firstFrame = frame;
+        block.frames = static_cast<int>(stepNs * kSampleRate / 1000000000LL);
+        if (withGap && frame >= 2 * kSampleRate && frame < 2 * kSampleRate + block.frames) {
+            block.droppedFrames = 12000;
+            block.firstFrame += block.droppedFrames;
+        }
+        block.timestampNs = static_cast<int64_t>(static_cast<double>(block.firstFrame) * 1e9 / kSampleRate);
+        pcm.resize(static_cast<size_t>(block.frames) * kChannels);
+        for (int i = 0; i < block.frames; ++i) {
+            for (int c = 0; c < kChannels; ++c) {
+                pcm[static_cast<size_t>(i) * kChannels + c] = sample(block.firstFrame + i, c);
+            }
+        }
+        pollNs += stepNs;
+        writer.write(pollNs, block, pcm.data(), pcm.size() * sizeof(int16_t));
+        frame = block.firstFrame + block.frames;
+    }
+    return true;
+}
+
+int16_t toPcm(double value)
+{
+    return static_cast<int16_t>(std::lround(std::max(-1.0, std::min(1.0, value)) * 32767.0));
+}
+
+// Two runs through the full pipeline, FIR filter and plugin included, must
+// agree bit for bit, and every branch must have seen the whole stream.
+void checkDeterminism(TestReport &report, const std::string &pluginPath)
+{
+    std::printf("-- determinism\n");
+    const std::string sessionPath = tempPath("tones.svcs");
+    std::mt19937 noise(11);
+    std::string error;
+    const bool written = writeSession(sessionPath, 6.0, true, [&noise](long long frame, int channel) {
+        const double t = static_cast<double>(frame) / kSampleRate;
+        const double hz = (channel == 0) ? 440.0 : 1000.0;
+        // A DC offset on the left for the plugin to remove.
+        const double dc = (channel == 0) ? 0.25 : 0.0;
+        return toPcm(dc + 0.3 * std::sin(2.0 * 3.14159265358979 * hz * t) + 1e-3 * (static_cast<int>(noise() % 200) - 100) / 100.0);
+    }, &error);
+    if (!report.expect(written, "write session %s", error.c_str())) {
+        return;
+    }
+
+    ReplayOptions options;
+    options.filter = FilterChain::PresetFirLowPass1k;
+    options.pluginPath = pluginPath;
+    ReplayRun runs[2];
+    for (int i = 0; i < 2; ++i) {
+        runs[i].recordPath = tempPath("record" + std::to_string(i) + ".wav");
+        if (!report.expect(replaySession(sessionPath, options, runs[i], &error), "replay %d %s", i, error.c_str())) {
+            return;
+        }
+    }
+    for (size_t i = 0; i < runs[0].digests.size(); ++i) {
+        std::printf("%s\n", runs[0].digests[i].c_str());
+        report.expect(runs[0].digests[i] == runs[1].digests[i], "second run matches: %s", runs[1].digests[i].c_str());
+    }
+
+    const ReplayRun &run = runs[0];
+    report.expect(run.gaps == 1 && run.dropped == 12000, "%lld frames dropped in %d gaps", run.dropped, run.gaps);
+    bool sawPlugin = false;
+    for (const NodeTiming &timing : run.timings) {
+        report.expect(timing.calls > 0, "node %s ran %lld times", timing.name.c_str(), timing.calls);
+        sawPlugin = sawPlugin || timing.name == "dc-block";
+    }
+    report.expect(sawPlugin, "dc-block plugin in the graph");
+
+    // The recording spans the stream with the gap padded, and the plugin
+    // has taken the offset out of it.
+    WavFile recorded;
+    if (report.expect(recorded.load(run.recordPath, &error), "load recording %s", error.c_str())) {
+        report.expect(recorded.frameCount() == run.frames + run.dropped, "recorded %d frames, expected %lld",
+            recorded.frameCount(), run.frames + run.dropped);
+        const std::vector<float> &left = recorded.channel(0);
+        double sum = 0.0;
+        for (size_t i = left.size() / 2; i < left.size(); ++i) {
+            sum += left[i];
+        }
+        const double mean = sum / static_cast<double>(left.size() - left.size() / 2);
+        report.expect(std::fabs(mean) < 0.01, "recorded left channel mean %.4f", mean);
+    }
+
+    fs::remove(sessionPath);
+    fs::remove(runs[0].recordPath);
+    fs::remove(runs[1].recordPath);
+}
+
+// A session whose capture is the generator's own MLS, returned after a known
+// delay: the pipeline must measure that delay with the output lead removed.
+void checkLoopback(TestReport &report)
+{
+    std::printf("-- loopback\n");
+    const int delayFrames = 600;
+    const int outputLead = 1920;
+    SignalGenerator generator;
+    generator.configure(kSampleRate);
+    generator.setType(SignalGenerator::TypeMls);
+    std::vector<float> emitted(static_cast<size_t>(6 * kSampleRate));
+    generator.generate(emitted.data(), static_cast<int>(emitted.size()));
+
+    const std::string sessionPath = tempPath("loopback.svcs");
+    std::string error;
+    const bool written = writeSession(sessionPath, 5.0, false, [&emitted](long long frame, int channel) {
+        (void)channel;
+        const long long source = frame - delayFrames - outputLead;
+        return (source >= 0) ? toPcm(emitted[static_cast<size_t>(source)]) : int16_t(0);
+    }, &error);
+    if (!report.expect(written, "write session %s", error.c_str())) {
+        return;
+    }
+
+    ReplayOptions options;
+    options.measureLoopback = true;
+    options.outputLead = outputLead;
+    ReplayRun run;
+    run.recordPath = tempPath("loopback.wav");
+    if (report.expect(replaySession(sessionPath, options, run, &error), "replay %s", error.c_str())
+        && report.expect(run.loopbackFinished && run.loopback.valid, "loopback measurement finished")) {
+        report.expectNear("latency samples", run.loopback.latencySamples, delayFrames, 1.0);
+    }
+    fs::remove(sessionPath);
+    fs::remove(run.recordPath);
+}
+
+int replayFile(int argc, char *argv[])
+{
+    std::string sessionPath;
+    std::string goldenPath;
+    std::string writeGoldenPath;
+    std::string mix = "average";
+    ReplayOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--realtime") {
+            options.realTime = true;
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = static_cast<FilterChain::Preset>(
+                std::clamp(std::atoi(argv[++i]), 0, static_cast<int>(FilterChain::PresetFirLowPass1k)));
+        } else if (arg == "--mix" && hasValue) {
+            mix = argv[++i];
+        } else if (arg == "--plugin" && hasValue) {
+            options.pluginPath = argv[++i];
+        } else if (arg == "--golden" && hasValue) {
+            goldenPath = argv[++i];
+        } else if (arg == "--write-golden" && hasValue) {
+            writeGoldenPath = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            printUsage(argv[0]);
+            return 2;
+        } else {
+            sessionPath = arg;
+        }
+    }
+
+    if (mix == "left") {
+        options.mix = ProcessingGraph::MixLeft;
+    } else if (mix == "right") {
+        options.mix = ProcessingGraph::MixRight;
+    } else if (mix != "average") {
+        std::fprintf(stderr, "Unknown mix: %s\n", mix.c_str());
+        return 2;
+    }
+    if (sessionPath.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    ReplayRun run;
+    run.recordPath = tempPath("record.wav");
+    std::string error;
+    const bool replayed = replaySession(sessionPath, options, run, &error);
+    fs::remove(run.recordPath);
+    if (!replayed) {
+        std::fprintf(stderr, "%s: %s\n", sessionPath.c_str(), error.c_str());
+        return 1;
+    }
+
+    const double audioMs = 1000.0 * static_cast<double>(run.frames) / run.sampleRate;
+    std::printf("session: %d ch, %d Hz, %lld blocks, %.1f s of audio, %lld frames dropped in %d gaps\n", run.channels,
+        run.sampleRate, run.blocks, audioMs / 1000.0, run.dropped, run.gaps);
+    std::printf("replay (%s): %.1f ms, %.1fx real time; worst poll load %.1f%%, %d polls over budget\n",
+        options.realTime ? "real time" : "flat out", run.elapsedMs,
+        (run.elapsedMs > 0.0) ? audioMs / run.elapsedMs : 0.0, 100.0 * run.worstLoad, run.overBudget);
+    std::printf("%-12s %10s %10s %10s\n", "node", "calls", "avg ms", "max ms");
+    for (const NodeTiming &timing : run.timings) {
+        std::printf("%-12s %10lld %10.4f %10.4f\n", timing.name.c_str(), timing.calls, timing.averageMs(), timing.maxMs);
+    }
+    for (size_t i = 2; i < run.digests.size(); ++i) {
+        std::printf("%s\n", run.digests[i].c_str());
+    }
+
+    if (!writeGoldenPath.empty()) {
+        std::ofstream out(writeGoldenPath, std::ios::trunc);
+        for (const std::string &line : run.digests) {
+            out << line << '\n';
+        }
+        if (!out) {
+            std::fprintf(stderr, "Cannot write %s\n", writeGoldenPath.c_str());
+            return 1;
+        }
+    }
+
+    if (goldenPath.empty()) {
+        return 0;
+    }
+    std::ifstream in(goldenPath);
+    if (!in) {
+        std::fprintf(stderr, "Cannot read %s\n", goldenPath.c_str());
+        return 1;
+    }
+    TestReport report;
+    std::string line;
+    for (const std::string &expected : run.digests) {
+        if (!std::getline(in, line)) {
+            line.clear();
+        }
+        report.expect(line == expected, "golden \"%s\", got \"%s\"", line.c_str(), expected.c_str());
+    }
+    return report.exitCode();
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1) {
+        return replayFile(argc, argv);
+    }
+
+    TestReport report;
+    checkDeterminism(report, SCOPEVIBE_TEST_PLUGIN);
+    checkLoopback(report);
+    return report.exitCode();
+}
@@ -0,0 +1,230 @@
+#include "sharedframereader.h"
+#include "sharedframering.h"
+#include "testsupport.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr int kFrames = 200000;
+constexpr int kChannels = 2;
+constexpr int kMaxCount = 500;
+constexpr uint32_t kSlotCount = 8;   // small, so readers are lapped constantly
+constexpr uint32_t kSlotBytes = kChannels * kMaxCount * sizeof(float);
+constexpr int kReaders = 4;
+
+// The whole payload is a function of the header, so a copy that mixes two
+// frames, or a header from one frame with a payload from another, shows up
+// as a mismatch.
+int frameCount(uint64_t frame)
+{
+    return 1 + static_cast<int>((frame * 7919) % kMaxCount);
+}
+
+float payloadValue(uint64_t firstSample, int index)
+{
+    return static_cast<float>((firstSample * 31 + static_cast<uint64_t>(index)) % 1000003);
+}
+
+std::string ringName()
+{
+#ifdef _WIN32
+    const unsigned long pid = GetCurrentProcessId();
+#else
+    const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    return "/scopevibe-ringtest-" + std::to_string(pid);
+}
+
+struct ReaderStats {
+    long long frames = 0;
+    long long mismatched = 0;
+    long long outOfOrder = 0;
+    unsigned long long lost = 0;
+    std::string error;
+};
+
+bool frameMatches(const SharedFrameInfo &info, const float *data, size_t values)
+{
+    if (info.kind != SharedFrame::KindSamples || info.channels != kChannels || info.sampleRate != 48000
+        || info.firstSample != info.frame || info.timestampNs != info.frame + 1
+        || info.count != frameCount(info.frame) || values != static_cast<size_t>(info.channels) * info.count) {
+        return false;
+    }
+    for (size_t i = 0; i < values; ++i) {
+        if (data[i] != payloadValue(info.firstSample, static_cast<int>(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Follows the writer with next(), the way a streaming client does.
+void followReader(const std::string &name, const std::atomic<bool> &writerDone, ReaderStats &stats)
+{
+    SharedFrameReader reader;
+    if (!reader.open(name, &stats.error)) {
+        return;
+    }
+
+    SharedFrameInfo info;
+    std::vector<float> data;
+    bool started = false;
+    uint64_t previous = 0;
+    for (;;) {
+        const bool finished = writerDone.load(std::memory_order_acquire);
+        const SharedFrameReader::Status status = reader.next(info, data);
+        if (status == SharedFrameReader::StatusOk) {
+            ++stats.frames;
+            if (!frameMatches(info, data.data(), data.size())) {
+                ++stats.mismatched;
+            }
+            if (started && info.frame <= previous) {
+                ++stats.outOfOrder;
+            }
+            started = true;
+            previous = info.frame;
+        } else if (finished) {
+            break;
+        }
+    }
+    stats.lost = reader.lostFrames();
+}
+
+// Checks zero-copy views of the newest frame in place, trusting the data
+// only when isValid() still holds afterwards.
+void viewReader(const std::string &name, const std::atomic<bool> &writerDone, ReaderStats &stats)
+{
+    SharedFrameReader reader;
+    if (!reader.open(name, &stats.error)) {
+        return;
+    }
+
+    SharedFrameReader::View view;
+    while (!writerDone.load(std::memory_order_acquire)) {
+        const uint64_t published = reader.published();
+        if (published == 0) {
+            continue;
+        }
+        if (reader.view(published - 1, view) != SharedFrameReader::StatusOk) {
+            continue;
+        }
+        const bool matches = frameMatches(view.info, view.data,
+            static_cast<size_t>(view.info.channels) * view.info.count);
+        if (!reader.isValid(view)) {
+            ++stats.lost;
+            continue;
+        }
+        ++stats.frames;
+        if (!matches) {
+            ++stats.mismatched;
+        }
+    }
+}
+
+// A writer that restarts under the same name, without closing the old ring
+// as after a crash, and then shuts down cleanly. A reader still attached
+// must be told to reopen each time instead of reading stale or renumbered
+// frames.
+void testRecreate(TestReport &report, const std::string &name)
+{
+    std::printf("-- writer recreates the ring\n");
+
+    const float sample[kChannels] = {1.0f, 2.0f};
+    SharedFrameRing first;
+    std::string error;
+    if (!report.expect(first.create(name, kSlotCount, kSlotBytes, &error), "create %s", error.c_str())) {
+        return;
+    }
+    SharedFrameReader reader;
+    if (!report.expect(reader.open(name, &error), "open %s", error.c_str())) {
+        return;
+    }
+    SharedFrameInfo info;
+    std::vector<float> data;
+    first.publish(SharedFrame::KindSamples, kChannels, 1, 48000, 0, sample, 1);
+    report.expect(reader.next(info, data) == SharedFrameReader::StatusOk, "frame from the first ring");
+
+    SharedFrameRing second;
+    report.expect(second.create(name, kSlotCount, kSlotBytes, &error), "recreate %s", error.c_str());
+    second.publish(SharedFrame::KindSamples, kChannels, 1, 48000, 0, sample, 1);
+    SharedFrameReader::View view;
+    report.expect(!reader.isCurrent() && reader.next(info, data) == SharedFrameReader::StatusReopen
+            && reader.view(0, view) == SharedFrameReader::StatusReopen,
+        "old reader told to reopen after the writer recreated the ring");
+
+    const uint64_t oldGeneration = reader.generation();
+    report.expect(reader.open(name, &error), "reopen %s", error.c_str());
+    report.expect(reader.generation() == oldGeneration + 1, "generation %llu after %llu",
+        static_cast<unsigned long long>(reader.generation()), static_cast<unsigned long long>(oldGeneration));
+    second.publish(SharedFrame::KindSamples, kChannels, 1, 48000, 1, sample, 2);
+    report.expect(reader.next(info, data) == SharedFrameReader::StatusOk && info.firstSample == 1,
+        "reopened reader follows the new ring");
+
+    second.close();
+    report.expect(reader.next(info, data) == SharedFrameReader::StatusReopen,
+        "reader told to reopen after the writer closed the ring");
+    first.close();
+}
+} // namespace
+
+int main()
+{
+    TestReport report;
+    const std::string name = ringName();
+
+    SharedFrameRing ring;
+    std::string error;
+    if (!report.expect(ring.create(name, kSlotCount, kSlotBytes, &error), "create ring %s %s", name.c_str(),
+            error.c_str())) {
+        return report.exitCode();
+    }
+
+    std::atomic<bool> writerDone(false);
+    std::vector<ReaderStats> stats(kReaders);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; ++r) {
+        if (r == 0) {
+            readers.emplace_back(viewReader, name, std::cref(writerDone), std::ref(stats[r]));
+        } else {
+            readers.emplace_back(followReader, name, std::cref(writerDone), std::ref(stats[r]));
+        }
+    }
+
+    // Full rate: no pacing, one slot-sized frame per publish().
+    std::vector<float> payload(static_cast<size_t>(kChannels) * kMaxCount);
+    for (uint64_t frame = 0; frame < static_cast<uint64_t>(kFrames); ++frame) {
+        const int count = frameCount(frame);
+        for (int i = 0; i < kChannels * count; ++i) {
+            payload[i] = payloadValue(frame, i);
+        }
+        ring.publish(SharedFrame::KindSamples, kChannels, count, 48000, frame, payload.data(), frame + 1);
+    }
+    writerDone.store(true, std::memory_order_release);
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+
+    report.expect(ring.isOpen(), "writer published %d frames", kFrames);
+    for (int r = 0; r < kReaders; ++r) {
+        const ReaderStats &s = stats[r];
+        std::printf("-- reader %d (%s): %lld frames, %llu lost or retried\n", r, (r == 0) ? "view" : "next",
+            s.frames, s.lost);
+        report.expect(s.error.empty(), "open %s", s.error.c_str());
+        report.expect(s.frames > 0, "read frames while the writer ran");
+        report.expect(s.mismatched == 0, "%lld frames with header and payload disagreeing", s.mismatched);
+        report.expect(s.outOfOrder == 0, "%lld frames out of order", s.outOfOrder);
+    }
+
+    ring.close();
+    testRecreate(report, name + "-recreate");
+    return report.exitCode();
+}
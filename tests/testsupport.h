@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+
+// Shared by the test executables. Every check prints one line; main()
+// returns exitCode() so CTest sees any failure.
+class TestReport
+{
+public:
+    bool expect(bool condition, const char *format, ...)
+    {
+        std::va_list args;
+        va_start(args, format);
+        std::printf("%s: ", condition ? "ok  " : "FAIL");
+        std::vprintf(format, args);
+        std::printf("\n");
+        va_end(args);
+        if (!condition) {
+            ++m_failures;
+        }
+        return condition;
+    }
+
+    bool expectNear(const char *what, double actual, double expected, double tolerance)
+    {
+        return expect(std::fabs(actual - expected) <= tolerance, "%s = %.6g, expected %.6g +- %.3g", what, actual,
+            expected, tolerance);
+    }
+
+    int failures() const { return m_failures; }
+    int exitCode() const { return (m_failures == 0) ? 0 : 1; }
+
+private:
+    int m_failures = 0;
+};
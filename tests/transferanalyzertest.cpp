@@ -0,0 +1,196 @@
+#include "testsupport.h"
+#include "transferanalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr int kSampleRate = 48000;
+constexpr int kFftSize = 8192;
+const double kPi = std::acos(-1.0);
+
+std::vector<float> whiteNoise(unsigned seed, int frames)
+{
+    std::mt19937 random(seed);
+    std::normal_distribution<float> gauss(0.0f, 0.25f);
+    std::vector<float> samples(frames);
+    for (float &sample : samples) {
+        sample = gauss(random);
+    }
+    return samples;
+}
+
+// Measured signal that is the reference scaled and shifted by `delay`
+// samples; a negative delay makes the measured channel lead.
+std::vector<float> delayed(const std::vector<float> &reference, double gain, int delay)
+{
+    std::vector<float> measured(reference.size(), 0.0f);
+    for (int i = 0; i < static_cast<int>(reference.size()); ++i) {
+        const int source = i - delay;
+        if (source >= 0 && source < static_cast<int>(reference.size())) {
+            measured[i] = static_cast<float>(gain * reference[source]);
+        }
+    }
+    return measured;
+}
+
+// Feeds both channels in 1000-frame blocks, as the scope does.
+void feed(TransferAnalyzer &analyzer, const std::vector<float> &reference, const std::vector<float> &measured)
+{
+    const int frames = static_cast<int>(reference.size());
+    for (int start = 0; start < frames; start += 1000) {
+        analyzer.process(reference.data() + start, measured.data() + start, std::min(1000, frames - start));
+    }
+}
+
+// Averages over the bins from 100 Hz to 20 kHz.
+double bandMean(const TransferResult &result, const std::vector<float> &values)
+{
+    const double binHz = static_cast<double>(result.sampleRate) / result.fftSize;
+    const int first = static_cast<int>(std::ceil(100.0 / binHz));
+    const int last = static_cast<int>(20000.0 / binHz);
+    double sum = 0.0;
+    for (int k = first; k <= last; ++k) {
+        sum += values[k];
+    }
+    return sum / (last - first + 1);
+}
+
+struct DelayCase {
+    const char *name = "";
+    double gain = 0.5;
+    int delay = 37;
+};
+
+void runDelayCase(TestReport &report, const DelayCase &test)
+{
+    std::printf("-- %s\n", test.name);
+
+    TransferAnalyzer analyzer;
+    analyzer.configure(kSampleRate, kFftSize);
+    const std::vector<float> reference = whiteNoise(1, 40 * kFftSize);
+    feed(analyzer, reference, delayed(reference, test.gain, test.delay));
+
+    const TransferResult &result = analyzer.result();
+    if (!report.expect(result.valid, "result after %d averages", result.averages)) {
+        return;
+    }
+    report.expectNear("magnitude dB", bandMean(result, result.magnitudeDb), 20.0 * std::log10(test.gain), 0.05);
+    report.expectNear("delay samples", result.delaySamples, test.delay, 0.01);
+    report.expectNear("delay ms", result.delayMs, 1000.0 * test.delay / kSampleRate, 0.001);
+    report.expect(bandMean(result, result.coherence) > 0.99, "coherence %.4f", bandMean(result, result.coherence));
+
+    // A pure delay turns the phase by -360 degrees * f * delay.
+    const int bin = 100;
+    const double expectedPhase = std::remainder(-360.0 * bin * test.delay / kFftSize, 360.0);
+    report.expectNear("phase at bin 100", std::remainder(result.phaseDeg[bin] - expectedPhase, 360.0), 0.0, 1.0);
+}
+
+// y[n] = (1 - a) x[n] + a y[n-1]: H = (1 - a) / (1 - a e^-jw).
+void testOnePole(TestReport &report)
+{
+    std::printf("-- one-pole low-pass\n");
+
+    const double a = 0.9;
+    const std::vector<float> reference = whiteNoise(2, 40 * kFftSize);
+    std::vector<float> measured(reference.size());
+    double state = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        state = (1.0 - a) * reference[i] + a * state;
+        measured[i] = static_cast<float>(state);
+    }
+
+    TransferAnalyzer analyzer;
+    analyzer.configure(kSampleRate, kFftSize);
+    analyzer.setAverages(0);
+    feed(analyzer, reference, measured);
+    const TransferResult &result = analyzer.result();
+
+    double worstDb = 0.0;
+    double worstDeg = 0.0;
+    for (int bin : {20, 100, 400, 1000, 2000, 4000}) {
+        const std::complex<double> h = (1.0 - a) / (1.0 - a * std::polar(1.0, -2.0 * kPi * bin / kFftSize));
+        worstDb = std::max(worstDb, std::fabs(result.magnitudeDb[bin] - 20.0 * std::log10(std::abs(h))));
+        worstDeg = std::max(worstDeg, std::fabs(result.phaseDeg[bin] - std::arg(h) * 180.0 / kPi));
+    }
+    report.expect(worstDb < 0.1, "magnitude within %.4f dB of the analytic response", worstDb);
+    report.expect(worstDeg < 0.5, "phase within %.4f degrees of the analytic response", worstDeg);
+}
+
+// Uncorrelated noise at the same power as the signal halves the coherence.
+void testCoherence(TestReport &report)
+{
+    std::printf("-- coherence with added noise\n");
+
+    const std::vector<float> reference = whiteNoise(3, 80 * kFftSize);
+    const std::vector<float> interference = whiteNoise(4, 80 * kFftSize);
+    std::vector<float> measured(reference.size());
+    for (size_t i = 0; i < reference.size(); ++i) {
+        measured[i] = reference[i] + interference[i];
+    }
+
+    TransferAnalyzer analyzer;
+    analyzer.configure(kSampleRate, kFftSize);
+    analyzer.setAverages(0);
+    feed(analyzer, reference, measured);
+    const TransferResult &result = analyzer.result();
+    report.expectNear("coherence", bandMean(result, result.coherence), 0.5, 0.03);
+    report.expectNear("magnitude dB", bandMean(result, result.magnitudeDb), 0.0, 0.2);
+}
+
+// The gain drops from 1 to 0.5 halfway through. A linear average reads
+// the mean response, 0.75; an exponential one forgets the first half.
+void testAveraging(TestReport &report)
+{
+    std::printf("-- linear and exponential averaging\n");
+
+    const int half = 60 * kFftSize / 2;
+    const std::vector<float> reference = whiteNoise(5, 2 * half);
+    std::vector<float> measured(reference.size());
+    for (int i = 0; i < 2 * half; ++i) {
+        measured[i] = (i < half) ? reference[i] : 0.5f * reference[i];
+    }
+
+    TransferAnalyzer linear;
+    linear.configure(kSampleRate, kFftSize);
+    linear.setAverages(0);
+    feed(linear, reference, measured);
+    const int frames = 2 * half / (kFftSize / 2) - 1;
+    report.expect(linear.result().averages == frames, "linear average over %d frames, expected %d",
+        linear.result().averages, frames);
+    report.expectNear("linear magnitude dB", bandMean(linear.result(), linear.result().magnitudeDb),
+        20.0 * std::log10(0.75), 0.1);
+
+    TransferAnalyzer exponential;
+    exponential.configure(kSampleRate, kFftSize);
+    exponential.setAverages(8);
+    feed(exponential, reference, measured);
+    report.expect(exponential.result().averages == 8, "exponential average reports %d frames",
+        exponential.result().averages);
+    report.expectNear("exponential magnitude dB", bandMean(exponential.result(), exponential.result().magnitudeDb),
+        20.0 * std::log10(0.5), 0.05);
+}
+} // namespace
+
+int main()
+{
+    TestReport report;
+
+    DelayCase lagging;
+    lagging.name = "gain 0.5, 37 samples late";
+    runDelayCase(report, lagging);
+
+    DelayCase leading;
+    leading.name = "gain 2, 20 samples early";
+    leading.gain = 2.0;
+    leading.delay = -20;
+    runDelayCase(report, leading);
+
+    testOnePole(report);
+    testCoherence(report);
+    testAveraging(report);
+    return report.exitCode();
+}
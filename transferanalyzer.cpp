@@ -0,0 +1,177 @@
+#include "transferanalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr int kMinFftSize = 256;
+constexpr int kMaxFftSize = 65536;
+constexpr double kFloorDb = -200.0;
+} // namespace
+
+TransferAnalyzer::TransferAnalyzer()
+{
+    configure(m_sampleRate, 8192);
+}
+
+void TransferAnalyzer::configure(int sampleRate, int fftSize)
+{
+    if (sampleRate > 0) {
+        m_sampleRate = sampleRate;
+    }
+    const int n = std::min(kMaxFftSize, Fft::nextPow2(std::max(kMinFftSize, fftSize)));
+    m_fft.setSize(n);
+    m_fftData.assign(n, std::complex<float>());
+    m_reference.assign(n, 0.0f);
+    m_measured.assign(n, 0.0f);
+
+    const double pi = std::acos(-1.0);
+    m_window.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * static_cast<double>(i) / n));
+    }
+
+    reset();
+}
+
+void TransferAnalyzer::setAverages(int count)
+{
+    m_averages = std::max(0, count);
+}
+
+void TransferAnalyzer::reset()
+{
+    const int bins = m_fft.size() / 2 + 1;
+    m_fill = 0;
+    m_frames = 0;
+    m_gxx.assign(bins, 0.0);
+    m_gyy.assign(bins, 0.0);
+    m_gxy.assign(bins, std::complex<double>());
+    m_result = TransferResult();
+}
+
+bool TransferAnalyzer::process(const float *reference, const float *measured, int count)
+{
+    const int n = m_fft.size();
+    const int hop = n / 2;
+    bool completed = false;
+
+    int offset = 0;
+    while (offset < count) {
+        const int take = std::min(count - offset, n - m_fill);
+        std::memcpy(m_reference.data() + m_fill, reference + offset, sizeof(float) * take);
+        std::memcpy(m_measured.data() + m_fill, measured + offset, sizeof(float) * take);
+        m_fill += take;
+        offset += take;
+
+        if (m_fill == n) {
+            analyzeFrame();
+            std::memmove(m_reference.data(), m_reference.data() + hop, sizeof(float) * (n - hop));
+            std::memmove(m_measured.data(), m_measured.data() + hop, sizeof(float) * (n - hop));
+            m_fill = n - hop;
+            completed = true;
+        }
+    }
+
+    if (completed) {
+        updateResult();
+    }
+    return completed;
+}
+
+void TransferAnalyzer::analyzeFrame()
+{
+    const int n = m_fft.size();
+    const int half = n / 2;
+
+    // Both real channels ride in one complex transform: z = x + i*y, then
+    // X[k] = (Z[k] + conj Z[n-k]) / 2 and Y[k] = (Z[k] - conj Z[n-k]) / 2i.
+    for (int i = 0; i < n; ++i) {
+        m_fftData[i] = std::complex<float>(m_reference[i] * m_window[i], m_measured[i] * m_window[i]);
+    }
+    m_fft.forward(m_fftData.data());
+
+    ++m_frames;
+    double alpha = 1.0 / static_cast<double>(m_frames);
+    if (m_averages > 0) {
+        alpha = std::max(alpha, 1.0 / static_cast<double>(m_averages));
+    }
+
+    for (int k = 0; k <= half; ++k) {
+        const std::complex<double> z(m_fftData[k]);
+        const std::complex<double> zc = std::conj(std::complex<double>(m_fftData[(n - k) & (n - 1)]));
+        const std::complex<double> x = 0.5 * (z + zc);
+        const std::complex<double> d = 0.5 * (z - zc);
+        const std::complex<double> y(d.imag(), -d.real());
+
+        m_gxx[k] += alpha * (std::norm(x) - m_gxx[k]);
+        m_gyy[k] += alpha * (std::norm(y) - m_gyy[k]);
+        m_gxy[k] += alpha * (std::conj(x) * y - m_gxy[k]);
+    }
+}
+
+void TransferAnalyzer::updateResult()
+{
+    const int n = m_fft.size();
+    const int half = n / 2;
+    const double radToDeg = 180.0 / std::acos(-1.0);
+
+    TransferResult &result = m_result;
+    result.valid = true;
+    result.sampleRate = m_sampleRate;
+    result.fftSize = n;
+    result.averages = static_cast<int>(std::min<long long>(m_frames, m_averages > 0 ? m_averages : m_frames));
+    result.magnitudeDb.resize(half + 1);
+    result.phaseDeg.resize(half + 1);
+    result.coherence.resize(half + 1);
+    result.impulse.resize(n);
+
+    double reference = 0.0;
+    for (int k = 0; k <= half; ++k) {
+        reference = std::max(reference, m_gxx[k]);
+    }
+    // Bins where the reference carries no energy have no defined response.
+    const double threshold = reference * 1e-12;
+
+    for (int k = 0; k <= half; ++k) {
+        std::complex<double> h;
+        double coherence = 0.0;
+        if (m_gxx[k] > threshold && m_gxx[k] > 0.0) {
+            h = m_gxy[k] / m_gxx[k];
+            if (m_gyy[k] > 0.0) {
+                coherence = std::norm(m_gxy[k]) / (m_gxx[k] * m_gyy[k]);
+            }
+        }
+        const double magnitude = std::abs(h);
+        result.magnitudeDb[k] = static_cast<float>(magnitude > 0.0 ? std::max(kFloorDb, 20.0 * std::log10(magnitude)) : kFloorDb);
+        result.phaseDeg[k] = static_cast<float>(std::arg(h) * radToDeg);
+        result.coherence[k] = static_cast<float>(std::min(1.0, coherence));
+
+        m_fftData[k] = std::complex<float>(h);
+        if (k > 0 && k < half) {
+            m_fftData[n - k] = std::conj(m_fftData[k]);
+        }
+    }
+    m_fftData[half] = std::complex<float>(m_fftData[half].real(), 0.0f);
+
+    m_fft.inverse(m_fftData.data());
+    int peak = 0;
+    for (int i = 0; i < n; ++i) {
+        result.impulse[i] = m_fftData[i].real();
+        if (std::fabs(result.impulse[i]) > std::fabs(result.impulse[peak])) {
+            peak = i;
+        }
+    }
+
+    // Parabolic interpolation on the magnitude around the peak gives a
+    // sub-sample delay.
+    const double a = std::fabs(result.impulse[(peak + n - 1) & (n - 1)]);
+    const double b = std::fabs(result.impulse[peak]);
+    const double c = std::fabs(result.impulse[(peak + 1) & (n - 1)]);
+    const double denominator = a - 2.0 * b + c;
+    const double fraction = (denominator != 0.0) ? 0.5 * (a - c) / denominator : 0.0;
+    const int lag = (peak > half) ? peak - n : peak;
+    result.delaySamples = static_cast<double>(lag) + fraction;
+    result.delayMs = 1000.0 * result.delaySamples / static_cast<double>(m_sampleRate);
+}
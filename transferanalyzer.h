@@ -0,0 +1,69 @@
+#pragma once
+
+#include "fft.h"
+
+#include <complex>
+#include <vector>
+
+struct TransferResult {
+    bool valid = false;
+    int sampleRate = 0;
+    int fftSize = 0;
+    int averages = 0;
+    // One entry per bin from DC to Nyquist.
+    std::vector<float> magnitudeDb;
+    std::vector<float> phaseDeg;
+    std::vector<float> coherence;
+    // Circular impulse response; index 0 is zero lag, negative lags wrap
+    // to the end.
+    std::vector<float> impulse;
+    double delaySamples = 0.0;
+    double delayMs = 0.0;
+};
+
+// Dual-channel transfer function of a device under test. The reference
+// (what was sent) and the measured signal (what came back) are windowed
+// with 50 % overlap and transformed together as one complex FFT. The
+// auto- and cross-spectra are averaged frame by frame, so every update
+// only costs the newly completed frames.
+class TransferAnalyzer
+{
+public:
+    TransferAnalyzer();
+
+    void configure(int sampleRate, int fftSize);
+    // Number of frames in the exponential average; 0 keeps a linear
+    // average over everything since reset().
+    void setAverages(int count);
+    void reset();
+
+    int sampleRate() const { return m_sampleRate; }
+    int fftSize() const { return m_fft.size(); }
+    int averages() const { return m_averages; }
+
+    // Returns true when at least one frame completed during this call and
+    // result() has been refreshed.
+    bool process(const float *reference, const float *measured, int count);
+    const TransferResult &result() const { return m_result; }
+
+private:
+    void analyzeFrame();
+    void updateResult();
+
+    int m_sampleRate = 48000;
+    int m_averages = 16;
+    int m_fill = 0;
+    long long m_frames = 0;
+
+    Fft m_fft;
+    std::vector<float> m_window;
+    std::vector<float> m_reference;
+    std::vector<float> m_measured;
+    std::vector<std::complex<float>> m_fftData;
+
+    std::vector<double> m_gxx;
+    std::vector<double> m_gyy;
+    std::vector<std::complex<double>> m_gxy;
+
+    TransferResult m_result;
+};
@@ -0,0 +1,165 @@
+#include "transferwidget.h"
+
+#include <QPainter>
+#include <QPainterPath>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr int kFftSize = 8192;
+constexpr double kLowestFrequency = 20.0;
+constexpr float kMagnitudeRangeDb = 40.0f;
+
+QString formatFrequency(double hz)
+{
+    if (hz >= 1000.0) {
+        return QString::number(hz / 1000.0, 'g', 3) + QStringLiteral("k");
+    }
+    return QString::number(hz, 'g', 3);
+}
+
+// Draws one trace into `area`, mapping `low`..`high` to bottom..top and
+// the bins onto a log frequency axis, one point per pixel column.
+void drawTrace(QPainter &painter, const QRectF &area, const std::vector<float> &values, double binHz,
+    double lowHz, double highHz, float low, float high, const QColor &color)
+{
+    painter.setPen(QPen(QColor(40, 40, 60)));
+    painter.drawRect(area);
+
+    const int columns = static_cast<int>(area.width());
+    const int last = static_cast<int>(values.size()) - 1;
+    if (columns < 2 || last < 1) {
+        return;
+    }
+
+    const double ratio = std::log(highHz / lowHz);
+    QPainterPath path;
+    for (int x = 0; x < columns; ++x) {
+        const double hz = lowHz * std::exp(ratio * x / (columns - 1));
+        const int bin = std::min(last, std::max(1, static_cast<int>(std::lround(hz / binHz))));
+        const float value = std::max(low, std::min(high, values[bin]));
+        const double y = area.bottom() - (value - low) / (high - low) * area.height();
+        if (x == 0) {
+            path.moveTo(area.left() + x, y);
+        } else {
+            path.lineTo(area.left() + x, y);
+        }
+    }
+    painter.setPen(QPen(color, 1.2));
+    painter.drawPath(path);
+}
+} // namespace
+
+TransferWidget::TransferWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(180);
+    setAutoFillBackground(false);
+}
+
+void TransferWidget::setAverages(int count)
+{
+    m_analyzer.setAverages(count);
+}
+
+void TransferWidget::setSamples(const QVector<float> &reference, const QVector<float> &measured, int sampleRate)
+{
+    if (sampleRate <= 0 || reference.size() != measured.size()) {
+        return;
+    }
+    if (sampleRate != m_analyzer.sampleRate()) {
+        m_analyzer.configure(sampleRate, kFftSize);
+    }
+
+    if (m_analyzer.process(reference.constData(), measured.constData(), reference.size())) {
+        m_result = m_analyzer.result();
+        update();
+    }
+}
+
+void TransferWidget::setResult(const TransferResult &result)
+{
+    m_result = result;
+    update();
+}
+
+void TransferWidget::reset()
+{
+    m_analyzer.reset();
+    m_result = TransferResult();
+    update();
+}
+
+void TransferWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(10, 10, 14));
+
+    const TransferResult &result = m_result;
+    if (!result.valid) {
+        painter.setPen(QColor(120, 120, 140));
+        painter.drawText(rect(), Qt::AlignCenter, QStringLiteral("No transfer data"));
+        return;
+    }
+
+    const int labelHeight = 14;
+    const double plotHeight = static_cast<double>(height() - labelHeight);
+    const double w = static_cast<double>(width() - 1);
+    const QRectF magnitudeArea(0.0, 0.0, w, plotHeight * 0.45);
+    const QRectF phaseArea(0.0, magnitudeArea.bottom(), w, plotHeight * 0.3);
+    const QRectF coherenceArea(0.0, phaseArea.bottom(), w, plotHeight * 0.25);
+
+    const double binHz = static_cast<double>(result.sampleRate) / result.fftSize;
+    const double nyquist = 0.5 * result.sampleRate;
+
+    // Centre the magnitude window on the mean level where the measurement
+    // is trustworthy so a fixed gain offset does not push the trace out.
+    double sum = 0.0;
+    int used = 0;
+    for (size_t k = 1; k < result.magnitudeDb.size(); ++k) {
+        if (result.coherence[k] > 0.9f) {
+            sum += result.magnitudeDb[k];
+            ++used;
+        }
+    }
+    const float center = (used > 0) ? static_cast<float>(std::round(sum / used / 10.0) * 10.0) : 0.0f;
+
+    drawTrace(painter, magnitudeArea, result.magnitudeDb, binHz, kLowestFrequency, nyquist,
+        center - kMagnitudeRangeDb, center + kMagnitudeRangeDb, QColor(0, 140, 220));
+    drawTrace(painter, phaseArea, result.phaseDeg, binHz, kLowestFrequency, nyquist,
+        -180.0f, 180.0f, QColor(220, 160, 0));
+    drawTrace(painter, coherenceArea, result.coherence, binHz, kLowestFrequency, nyquist,
+        0.0f, 1.0f, QColor(0, 200, 120));
+
+    painter.setFont(QFont(painter.font().family(), 8));
+    painter.setPen(QPen(QColor(150, 150, 170), 1.0));
+    painter.drawText(QPointF(2.0, magnitudeArea.top() + 10.0),
+        QString::number(center + kMagnitudeRangeDb) + QStringLiteral(" dB"));
+    painter.drawText(QPointF(2.0, magnitudeArea.bottom() - 2.0),
+        QString::number(center - kMagnitudeRangeDb) + QStringLiteral(" dB"));
+    painter.drawText(QPointF(2.0, phaseArea.top() + 10.0), QStringLiteral("Phase"));
+    painter.drawText(QPointF(2.0, coherenceArea.top() + 10.0), QStringLiteral("Coherence"));
+
+    const QString delay = QStringLiteral("Delay %1 ms (%2 samples), %3 averages")
+        .arg(result.delayMs, 0, 'f', 3)
+        .arg(result.delaySamples, 0, 'f', 1)
+        .arg(result.averages);
+    painter.drawText(QRectF(0.0, 0.0, w - 4.0, 14.0), Qt::AlignRight | Qt::AlignVCenter, delay);
+
+    const double ratio = std::log(nyquist / kLowestFrequency);
+    for (double decade = 10.0; decade < nyquist; decade *= 10.0) {
+        for (double step : {1.0, 2.0, 5.0}) {
+            const double hz = decade * step;
+            if (hz < kLowestFrequency || hz > nyquist) {
+                continue;
+            }
+            const double x = w * std::log(hz / kLowestFrequency) / ratio;
+            painter.drawLine(QPointF(x, plotHeight), QPointF(x, plotHeight - 4.0));
+            painter.drawText(QPointF(x + 2.0, height() - 2.0), formatFrequency(hz));
+        }
+    }
+}
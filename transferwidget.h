@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QVector>
+#include <QWidget>
+
+#include "transferanalyzer.h"
+
+// Transfer function of the right channel relative to the left: magnitude,
+// phase and coherence on a log frequency axis, plus the estimated delay.
+class TransferWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TransferWidget(QWidget *parent = nullptr);
+
+    void setAverages(int count);
+    // Shows a result computed elsewhere, e.g. a loopback measurement.
+    // Replaced again by the next live update.
+    void setResult(const TransferResult &result);
+
+public slots:
+    void setSamples(const QVector<float> &reference, const QVector<float> &measured, int sampleRate);
+    void reset();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    TransferAnalyzer m_analyzer;
+    TransferResult m_result;
+};
@@ -0,0 +1,79 @@
+#include "triggerdetector.h"
+
+#include <algorithm>
+
+void TriggerDetector::setThreshold(float level)
+{
+    m_threshold = level;
+}
+
+void TriggerDetector::setHysteresis(float amount)
+{
+    m_hysteresis = std::max(0.0f, amount);
+}
+
+void TriggerDetector::setHoldoff(int frames)
+{
+    m_holdoff = std::max(0, frames);
+}
+
+void TriggerDetector::setSlope(Slope slope)
+{
+    m_slope = slope;
+}
+
+void TriggerDetector::reset(int64_t startIndex)
+{
+    m_index = startIndex;
+    m_lastEvent = INT64_MIN / 2;
+    m_armedHigh = false;
+    m_armedLow = false;
+}
+
+int TriggerDetector::process(const float *samples, int count, std::vector<TriggerEvent> &events)
+{
+    const float low = m_threshold - m_hysteresis;
+    const float high = m_threshold + m_hysteresis;
+    const bool wantRising = m_slope != SlopeFalling;
+    const bool wantFalling = m_slope != SlopeRising;
+
+    int added = 0;
+    for (int i = 0; i < count; ++i, ++m_index) {
+        const float value = samples[i];
+
+        // A rising edge is armed once the signal has been below the lower
+        // hysteresis bound, and fires when it crosses the upper one.
+        if (value < low) {
+            m_armedHigh = true;
+        }
+        if (value > high) {
+            m_armedLow = true;
+        }
+
+        bool rising = false;
+        bool fired = false;
+        if (m_armedHigh && value >= high) {
+            m_armedHigh = false;
+            if (wantRising) {
+                rising = true;
+                fired = true;
+            }
+        } else if (m_armedLow && value <= low) {
+            m_armedLow = false;
+            if (wantFalling) {
+                fired = true;
+            }
+        }
+
+        if (fired && m_index - m_lastEvent > m_holdoff) {
+            TriggerEvent event;
+            event.sampleIndex = m_index;
+            event.level = value;
+            event.rising = rising;
+            events.push_back(event);
+            m_lastEvent = m_index;
+            ++added;
+        }
+    }
+    return added;
+}
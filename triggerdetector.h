@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct TriggerEvent {
+    int64_t sampleIndex = 0;
+    float level = 0.0f;
+    bool rising = true;
+};
+
+// Edge trigger with hysteresis and holdoff. Sample indices keep counting
+// across process() calls so events from a stream stay absolute.
+class TriggerDetector
+{
+public:
+    enum Slope {
+        SlopeRising = 0,
+        SlopeFalling = 1,
+        SlopeBoth = 2
+    };
+
+    void setThreshold(float level);
+    void setHysteresis(float amount);
+    void setHoldoff(int frames);
+    void setSlope(Slope slope);
+    void reset(int64_t startIndex = 0);
+
+    float threshold() const { return m_threshold; }
+
+    // Appends detected edges to events and returns how many were added.
+    int process(const float *samples, int count, std::vector<TriggerEvent> &events);
+
+private:
+    float m_threshold = 0.5f;
+    float m_hysteresis = 0.01f;
+    int m_holdoff = 0;
+    Slope m_slope = SlopeRising;
+
+    int64_t m_index = 0;
+    int64_t m_lastEvent = INT64_MIN / 2;
+    bool m_armedHigh = false;
+    bool m_armedLow = false;
+};
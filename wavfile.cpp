@@ -0,0 +1,274 @@
+#include "wavfile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+uint16_t readU16(const uint8_t *p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t readU32(const uint8_t *p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+        | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void writeU16(std::ofstream &out, uint16_t value)
+{
+    const char bytes[2] = {static_cast<char>(value & 0xFF), static_cast<char>(value >> 8)};
+    out.write(bytes, 2);
+}
+
+void writeU32(std::ofstream &out, uint32_t value)
+{
+    const char bytes[4] = {static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF),
+        static_cast<char>((value >> 16) & 0xFF), static_cast<char>(value >> 24)};
+    out.write(bytes, 4);
+}
+
+bool fail(std::string *error, const char *message)
+{
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+float decodeSample(const uint8_t *p, uint16_t format, int bits)
+{
+    if (format == kFormatFloat) {
+        if (bits == 64) {
+            double value = 0.0;
+            std::memcpy(&value, p, sizeof(value));
+            return static_cast<float>(value);
+        }
+        float value = 0.0f;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    switch (bits) {
+    case 8:
+        return (static_cast<float>(p[0]) - 128.0f) / 128.0f;
+    case 16:
+        return static_cast<float>(static_cast<int16_t>(readU16(p))) / 32768.0f;
+    case 24: {
+        int32_t value = static_cast<int32_t>(p[0] | (p[1] << 8) | (p[2] << 16));
+        if (value & 0x800000) {
+            value |= ~0xFFFFFF;
+        }
+        return static_cast<float>(value) / 8388608.0f;
+    }
+    case 32:
+    default:
+        return static_cast<float>(static_cast<int32_t>(readU32(p))) / 2147483648.0f;
+    }
+}
+
+void writeHeader(std::ofstream &out, uint32_t channelCount, uint32_t sampleRate, uint32_t dataBytes)
+{
+    const uint32_t blockAlign = channelCount * 2;
+    out.write("RIFF", 4);
+    writeU32(out, 36 + dataBytes);
+    out.write("WAVE", 4);
+    out.write("fmt ", 4);
+    writeU32(out, 16);
+    writeU16(out, kFormatPcm);
+    writeU16(out, static_cast<uint16_t>(channelCount));
+    writeU32(out, sampleRate);
+    writeU32(out, sampleRate * blockAlign);
+    writeU16(out, static_cast<uint16_t>(blockAlign));
+    writeU16(out, 16);
+    out.write("data", 4);
+    writeU32(out, dataBytes);
+}
+} // namespace
+
+bool WavFile::load(const std::string &path, std::string *error)
+{
+    m_sampleRate = 0;
+    m_channels.clear();
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return fail(error, "cannot open file");
+    }
+    std::vector<uint8_t> bytes(static_cast<size_t>(std::max<std::streamoff>(0, in.tellg())));
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        return fail(error, "read failed");
+    }
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        return fail(error, "not a RIFF/WAVE file");
+    }
+
+    uint16_t format = 0;
+    int channels = 0;
+    int bits = 0;
+    int blockAlign = 0;
+    const uint8_t *data = nullptr;
+    size_t dataBytes = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= bytes.size()) {
+        const uint8_t *chunk = bytes.data() + pos;
+        const size_t chunkSize = readU32(chunk + 4);
+        const size_t available = std::min(chunkSize, bytes.size() - pos - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+            format = readU16(chunk + 8);
+            channels = readU16(chunk + 10);
+            m_sampleRate = static_cast<int>(readU32(chunk + 12));
+            blockAlign = readU16(chunk + 20);
+            bits = readU16(chunk + 22);
+            if (format == kFormatExtensible && available >= 40) {
+                format = readU16(chunk + 32);
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            dataBytes = available;
+        }
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (channels <= 0 || m_sampleRate <= 0 || blockAlign <= 0) {
+        return fail(error, "missing or invalid fmt chunk");
+    }
+    if (!data) {
+        return fail(error, "missing data chunk");
+    }
+    const bool pcm = format == kFormatPcm && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+    const bool floating = format == kFormatFloat && (bits == 32 || bits == 64);
+    if (!pcm && !floating) {
+        return fail(error, "unsupported sample format");
+    }
+
+    const int bytesPerSample = bits / 8;
+    if (blockAlign < channels * bytesPerSample) {
+        return fail(error, "invalid block alignment");
+    }
+
+    const size_t frames = dataBytes / static_cast<size_t>(blockAlign);
+    m_channels.assign(channels, std::vector<float>(frames));
+    for (size_t i = 0; i < frames; ++i) {
+        const uint8_t *frame = data + i * blockAlign;
+        for (int c = 0; c < channels; ++c) {
+            m_channels[c][i] = decodeSample(frame + c * bytesPerSample, format, bits);
+        }
+    }
+    return true;
+}
+
+bool WavFile::save(const std::string &path, const std::vector<std::vector<float>> &channels, int sampleRate,
+    std::string *error)
+{
+    if (channels.empty() || sampleRate <= 0) {
+        return fail(error, "nothing to write");
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return fail(error, "cannot create file");
+    }
+
+    const uint32_t channelCount = static_cast<uint32_t>(channels.size());
+    const uint32_t frames = static_cast<uint32_t>(channels.front().size());
+    writeHeader(out, channelCount, static_cast<uint32_t>(sampleRate), frames * channelCount * 2);
+
+    for (uint32_t i = 0; i < frames; ++i) {
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            const float value = (i < channels[c].size()) ? std::clamp(channels[c][i], -1.0f, 1.0f) : 0.0f;
+            writeU16(out, static_cast<uint16_t>(static_cast<int16_t>(value * 32767.0f)));
+        }
+    }
+
+    if (!out) {
+        return fail(error, "write failed");
+    }
+    return true;
+}
+
+WavWriter::~WavWriter()
+{
+    close();
+}
+
+bool WavWriter::open(const std::string &path, int channels, int sampleRate, int maxFrames, std::string *error)
+{
+    close();
+    if (channels <= 0 || sampleRate <= 0 || maxFrames <= 0) {
+        return fail(error, "invalid format");
+    }
+
+    m_out.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_out) {
+        return fail(error, "cannot create file");
+    }
+
+    m_channels = channels;
+    m_maxFrames = maxFrames;
+    m_frames = 0;
+    m_bytes.assign(static_cast<size_t>(maxFrames) * channels * 2, 0);
+    writeHeader(m_out, static_cast<uint32_t>(channels), static_cast<uint32_t>(sampleRate), 0);
+    return static_cast<bool>(m_out);
+}
+
+bool WavWriter::write(const float *interleaved, int frames)
+{
+    if (!m_out.is_open()) {
+        return false;
+    }
+
+    while (frames > 0) {
+        const int chunk = std::min(frames, m_maxFrames);
+        const int values = chunk * m_channels;
+        for (int i = 0; i < values; ++i) {
+            const float value = std::clamp(interleaved[i], -1.0f, 1.0f);
+            const uint16_t pcm = static_cast<uint16_t>(static_cast<int16_t>(value * 32767.0f));
+            m_bytes[2 * i] = static_cast<char>(pcm & 0xFF);
+            m_bytes[2 * i + 1] = static_cast<char>(pcm >> 8);
+        }
+        m_out.write(m_bytes.data(), static_cast<std::streamsize>(values) * 2);
+        m_frames += chunk;
+        interleaved += values;
+        frames -= chunk;
+    }
+    return static_cast<bool>(m_out);
+}
+
+bool WavWriter::writeSilence(long long frames)
+{
+    if (!m_out.is_open()) {
+        return false;
+    }
+
+    std::fill(m_bytes.begin(), m_bytes.end(), 0);
+    while (frames > 0) {
+        const int chunk = static_cast<int>(std::min<long long>(frames, m_maxFrames));
+        m_out.write(m_bytes.data(), static_cast<std::streamsize>(chunk) * m_channels * 2);
+        m_frames += chunk;
+        frames -= chunk;
+    }
+    return static_cast<bool>(m_out);
+}
+
+void WavWriter::close()
+{
+    if (!m_out.is_open()) {
+        return;
+    }
+
+    const uint32_t dataBytes = static_cast<uint32_t>(m_frames * m_channels * 2);
+    m_out.seekp(4);
+    writeU32(m_out, 36 + dataBytes);
+    m_out.seekp(40);
+    writeU32(m_out, dataBytes);
+    m_out.close();
+}
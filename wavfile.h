@@ -0,0 +1,49 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class WavFile
+{
+public:
+    bool load(const std::string &path, std::string *error = nullptr);
+    static bool save(const std::string &path, const std::vector<std::vector<float>> &channels, int sampleRate,
+        std::string *error = nullptr);
+
+    int sampleRate() const { return m_sampleRate; }
+    int channelCount() const { return static_cast<int>(m_channels.size()); }
+    int frameCount() const { return m_channels.empty() ? 0 : static_cast<int>(m_channels.front().size()); }
+    const std::vector<float> &channel(int index) const { return m_channels[index]; }
+
+private:
+    int m_sampleRate = 0;
+    std::vector<std::vector<float>> m_channels;
+};
+
+// Streams interleaved float frames to a 16-bit PCM file. The conversion
+// buffer is sized in open(), so write() does not allocate; the RIFF sizes
+// are filled in by close().
+class WavWriter
+{
+public:
+    ~WavWriter();
+
+    bool open(const std::string &path, int channels, int sampleRate, int maxFrames,
+        std::string *error = nullptr);
+    bool write(const float *interleaved, int frames);
+    // Pads over frames that never arrived, keeping file time in step with
+    // device time.
+    bool writeSilence(long long frames);
+    void close();
+
+    bool isOpen() const { return m_out.is_open(); }
+    long long framesWritten() const { return m_frames; }
+
+private:
+    std::ofstream m_out;
+    int m_channels = 0;
+    int m_maxFrames = 0;
+    long long m_frames = 0;
+    std::vector<char> m_bytes;
+};
@@ -0,0 +1,112 @@
+#include "workstealingpool.h"
+
+#include <algorithm>
+
+namespace {
+thread_local const WorkStealingPool *t_pool = nullptr;
+thread_local int t_workerIndex = -1;
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int threads)
+{
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    for (int i = 0; i < threads; ++i) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    const int count = threadCount();
+    const int index = (t_pool == this)
+        ? t_workerIndex
+        : static_cast<int>(m_nextQueue.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned>(count));
+
+    m_pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_queued.fetch_add(1);
+    }
+    m_wake.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_waitMutex);
+    m_idle.wait(lock, [this]() { return m_pending.load() == 0; });
+}
+
+void WorkStealingPool::run(int index)
+{
+    t_pool = this;
+    t_workerIndex = index;
+
+    for (;;) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            m_queued.fetch_sub(1);
+            task();
+            if (m_pending.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(m_waitMutex);
+                m_idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_waitMutex);
+        m_wake.wait(lock, [this]() { return m_stop || m_queued.load() > 0; });
+        if (m_stop && m_queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(int index, Task &task)
+{
+    Queue &queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int index, Task &task)
+{
+    const int count = threadCount();
+    for (int offset = 1; offset < count; ++offset) {
+        Queue &queue = *m_queues[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
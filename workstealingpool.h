@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool where each worker owns a deque: it pops its own
+// newest task and steals the oldest task from a sibling when it runs dry.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    int threadCount() const { return static_cast<int>(m_queues.size()); }
+
+    // Safe to call from worker tasks; those land on the caller's own deque.
+    void submit(Task task);
+    void wait();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(int index);
+    bool popLocal(int index, Task &task);
+    bool steal(int index, Task &task);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_waitMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::atomic<int> m_queued{0};
+    std::atomic<int> m_pending{0};
+    std::atomic<unsigned> m_nextQueue{0};
+    bool m_stop = false;
+};